@@ -19,27 +19,16 @@ def parse() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def read_file(filepath: str) -> List[List[float]]:
-    """Function to read datapoints from file
+def read_file(filepath: str) -> np.ndarray:
+    """Function to read datapoints from file, parsed (or for a binary dataset mapped) in C
 
     Args:
-        filepath (str): filepath to .txt file containing valid datapoints
+        filepath (str): filepath to .txt file containing valid datapoints, or to a binary dataset
 
     Returns:
-        List[List[float]: 2D Array, each element is a datapoint which is itself an array of floats
+        np.ndarray: n x d array, each row is a datapoint
     """
-    points: List[List[float]] = []
-    with open(filepath, "r", encoding="utf-8") as file:
-        for line in file:
-            line = line.strip()
-            point = line.split(",")
-            try:
-                point = list(map(float, point))
-            except ValueError:
-                print("An Error Has Occurred")
-                exit(1)
-            points.append(point)
-    return points
+    return symnmf_py.read_file(filepath)
 
 
 def kmeans_silhouette_score(K: int, datapoints: List[List[float]], filepath: str) -> float:
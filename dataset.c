@@ -0,0 +1,214 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "utils.h"
+#include "dataset.h"
+#define dataset_field_size 8
+
+/* Binary dataset layout: a dataset_header_size byte header followed by the n x d points in row major order, as little endian IEEE doubles
+   (element size 8) or floats (element size 4). The header holds dataset_magic and then three 8 byte little endian unsigned fields: n, d and
+   the element size, the rest of it is zero. The points start 64 bytes into the file, so a mapping of the file has them aligned. */
+
+
+int dataset_is_binary(const char *filename) {
+    /* Checks whether a file starts with the binary dataset magic. Returns 1 if it does, 0 if it doesn't or can't be read.
+    Input:
+        - const char *filename: Path of the file.
+    */
+    char magic[dataset_magic_size];
+    FILE *file = fopen(filename, "rb");
+    int binary;
+    if (file == NULL) {
+        return 0;
+    }
+    binary = fread(magic, 1, dataset_magic_size, file) == dataset_magic_size && memcmp(magic, dataset_magic, dataset_magic_size) == 0;
+    fclose(file);
+    return binary;
+}
+
+
+unsigned long dataset_header_field(const unsigned char *header, int field) {
+    /* Decodes one of the header's little endian fields.
+    Input:
+        - const unsigned char header[]: The dataset_header_size byte header.
+        - int field: 0 for n, 1 for d, 2 for the element size.
+    Returns:
+        The field's value, ULONG_MAX if it does not fit an unsigned long.
+    */
+    int i;
+    unsigned long value = 0;
+    const unsigned char *bytes = header + dataset_magic_size + field * dataset_field_size;
+    for (i = dataset_field_size - 1; i >= 0; i--) {
+        if (value > (ULONG_MAX >> 8)) {
+            return ULONG_MAX;
+        }
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+
+void dataset_header(unsigned char *header, int n, int d, int element_size) {
+    /* Encodes a binary dataset header.
+    Input:
+        - unsigned char header[]: Receives the dataset_header_size byte header.
+        - int n: Number of points.
+        - int d: Number of coordinates in each point.
+        - int element_size: sizeof(double) or sizeof(float).
+    */
+    int i, field;
+    unsigned long value;
+    memset(header, 0, dataset_header_size);
+    memcpy(header, dataset_magic, dataset_magic_size);
+    for (field = 0; field < 3; field++) {
+        value = (field == 0) ? (unsigned long)n : (field == 1) ? (unsigned long)d : (unsigned long)element_size;
+        for (i = 0; i < dataset_field_size && value != 0; i++) {
+            header[dataset_magic_size + field * dataset_field_size + i] = (unsigned char)(value & 0xFF);
+            value >>= 8;
+        }
+    }
+}
+
+
+dataset *dataset_open(const char *filename) {
+    /* Opens a binary dataset by memory mapping it, no parsing takes place: double points are used straight from the mapping (privately, so
+       writes to them never reach the file) and float points are widened to double once. Returns NULL on error, including a malformed header
+       or a file too short for the points its header announces.
+    Input:
+        - const char *filename: Path of the binary dataset.
+    Returns:
+        Dataset whose rows hold the n points of d coordinates each.
+    */
+    int i, j, descriptor;
+    struct stat status;
+    unsigned long n, d, element_size;
+    float *values;
+    dataset *data = malloc(sizeof(dataset));
+    if (data == NULL) {
+        return NULL;
+    }
+    data->rows = NULL;
+    data->widened = NULL;
+    descriptor = open(filename, O_RDONLY);
+    if (descriptor < 0 || fstat(descriptor, &status) != 0 || status.st_size < dataset_header_size) {
+        if (descriptor >= 0) close(descriptor);
+        free(data);
+        return NULL;
+    }
+    data->size = (size_t)status.st_size;
+    data->mapping = mmap(NULL, data->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    close(descriptor); /* The mapping keeps the file alive */
+    if (data->mapping == MAP_FAILED) {
+        free(data);
+        return NULL;
+    }
+    n = dataset_header_field((unsigned char *)data->mapping, 0);
+    d = dataset_header_field((unsigned char *)data->mapping, 1);
+    element_size = dataset_header_field((unsigned char *)data->mapping, 2);
+    if (memcmp(data->mapping, dataset_magic, dataset_magic_size) != 0 || n == 0 || d == 0 || n > INT_MAX || d > INT_MAX ||
+        (element_size != sizeof(double) && element_size != sizeof(float)) ||
+        (data->size - dataset_header_size) / element_size / d < n) {
+        munmap(data->mapping, data->size);
+        free(data);
+        return NULL;
+    }
+    data->n = (int)n;
+    data->d = (int)d;
+    data->element_size = (int)element_size;
+    if (element_size == sizeof(float)) {
+        data->widened = continuous_matrix_creation(data->n, data->d);
+        if (data->widened == NULL) {
+            free_dataset(data);
+            return NULL;
+        }
+        values = (float *)(data->mapping + dataset_header_size);
+        for (i = 0; i < data->n; i++) {
+            for (j = 0; j < data->d; j++) {
+                data->widened[i][j] = values[(size_t)i * data->d + j];
+            }
+        }
+        munmap(data->mapping, data->size); /* Only the widened copy is used from here on */
+        data->mapping = NULL;
+        data->rows = data->widened;
+        return data;
+    }
+    data->rows = malloc(data->n * sizeof(double *));
+    if (data->rows == NULL) {
+        free_dataset(data);
+        return NULL;
+    }
+    for (i = 0; i < data->n; i++) {
+        data->rows[i] = (double *)(data->mapping + dataset_header_size) + (size_t)i * data->d;
+    }
+    return data;
+}
+
+
+void free_dataset(dataset *data) {
+    /* Frees up dataset memory by unmapping its file (or freeing its widened points) and freeing its row pointers.
+    Input:
+        - dataset *data: Dataset whose memory we are freeing, can be NULL.
+    */
+    if (data == NULL) return;
+    if (data->widened != NULL) {
+        free_continuous_matrix(data->widened);
+    }
+    else {
+        free(data->rows);
+    }
+    if (data->mapping != NULL) {
+        munmap(data->mapping, data->size);
+    }
+    free(data);
+}
+
+
+int dataset_write(const char *filename, double **points, int n, int d, int element_size) {
+    /* Writes points as a binary dataset (see the layout at the top of this file), overwriting the file if it exists. Returns -1 on error,
+       0 otherwise.
+    Input:
+        - const char *filename: Path of the file to write.
+        - double points[][]: nxd points.
+        - int n: Number of points.
+        - int d: Number of coordinates in each point.
+        - int element_size: sizeof(double) to store the points as doubles, sizeof(float) to round them to floats.
+    */
+    int i, j, failed = 0;
+    unsigned char header[dataset_header_size];
+    float *row = NULL;
+    FILE *file;
+    if ((element_size != sizeof(double) && element_size != sizeof(float)) || n <= 0 || d <= 0) {
+        return -1;
+    }
+    dataset_header(header, n, d, element_size);
+    if (element_size == sizeof(float) && (row = malloc(d * sizeof(float))) == NULL) {
+        return -1;
+    }
+    file = fopen(filename, "wb");
+    if (file == NULL) {
+        free(row);
+        return -1;
+    }
+    failed = fwrite(header, 1, dataset_header_size, file) != dataset_header_size;
+    for (i = 0; i < n && !failed; i++) {
+        if (row == NULL) {
+            failed = fwrite(points[i], sizeof(double), d, file) != (size_t)d;
+            continue;
+        }
+        for (j = 0; j < d; j++) {
+            row[j] = (float)points[i][j];
+        }
+        failed = fwrite(row, sizeof(float), d, file) != (size_t)d;
+    }
+    free(row);
+    if (fclose(file) != 0 || failed) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#define dataset_magic "SYMNMFDS"
+#define dataset_magic_size 8
+#define dataset_header_size 64
+
+typedef struct dataset {
+    double **rows;
+    double **widened;
+    char *mapping;
+    size_t size;
+    int n;
+    int d;
+    int element_size;
+} dataset;
+
+int dataset_is_binary(const char *filename);
+
+unsigned long dataset_header_field(const unsigned char *header, int field);
+
+void dataset_header(unsigned char *header, int n, int d, int element_size);
+
+dataset *dataset_open(const char *filename);
+
+void free_dataset(dataset *data);
+
+int dataset_write(const char *filename, double **points, int n, int d, int element_size);
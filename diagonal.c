@@ -1,43 +1,28 @@
 #include "utils.h"
+#include "sym.h"
 #include <stdlib.h>
 
-double matrix_row_sum(double row[], int num_points) {
-    /* Helper function for diagonal matrix creation, calculates the sum of the i'th row in the similarity matrix.
-    Input:
-        - double row[]: i'th row in the similarity matrix we are currently calculating the sum of.
-        - int num_points: Length of the i'th row
-    Returns:
-        Sum of the i'th row in the similarity matrix
-    */
-    int i;
-    double sum = 0.0;
-    for (i = 0; i < num_points; i++) {
-        sum += row[i];
-    }
-    return sum;
-}
 
-
-double **diagonal_matrix(double **similarity_matrix, int num_points) {
-    /* Creates diagonal matrix as per project instructions. Returns NULL on error.
+double *diagonal_vector(double **datapoints, int num_points, int point_dimension, int exact_exp) {
+    /* Creates diagonal matrix as per project instructions, stored as its diagonal alone since every other entry is zero. Returns NULL on error.
+       Row sums are accumulated as the similarity matrix is streamed (see similarity_matrix_stream), which is never stored, so only O(n)
+       memory is used. The degrees are always summed in double precision.
     Input: 
-        - double Similarity Matrix[][]: Matrix where each entry corresponds to similarity between points as described in PDF.
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
         - int num_points: Number of points in Datapoints, this is also the size of the diagonal matrix as the matrix has a diagonal 
           of length n (each diagonal entry corresponds to a row in the similarity matrix)
+        - int point_dimension: Number of coordinates in each point.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
     Returns:
-        2D Square Diagonal Matrix, Diagonal entry i equals sum of row i in Similarity Matrix, all other entries are 0 (taken care of by continuous_matrix_creation_function who uses calloc)
+        Array of num_points, entry i equals sum of row i in Similarity Matrix
     */
-    int i;
-    double **diagonal_matrix;
-    
-    diagonal_matrix = continuous_matrix_creation(num_points, num_points);
-    if (diagonal_matrix == NULL) {
+    double *degrees = calloc(num_points, sizeof(double));
+    if (degrees == NULL) {
         return NULL;
     }
-    
-    for (i = 0; i < num_points; i++) {
-        /* Calloc instantiates all elements to zero, therefore no need to set d_ij = 0 manually for i != j */
-        diagonal_matrix[i][i] = matrix_row_sum(similarity_matrix[i], num_points);
+    if (similarity_matrix_stream(datapoints, num_points, point_dimension, degrees, NULL, NULL, exact_exp) != 0) {
+        free(degrees);
+        return NULL;
     }
-    return diagonal_matrix;
-}
\ No newline at end of file
+    return degrees;
+}
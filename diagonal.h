@@ -1,4 +1 @@
-
-double matrix_row_sum(double row[], int num_points);
-
-double **diagonal_matrix(double **similarity_matrix, int num_points);
\ No newline at end of file
+double *diagonal_vector(double **datapoints, int num_points, int point_dimension, int exact_exp);
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <math.h>
+#include "fastexp.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define fastexp_x86 1
+#endif
+#define exp_underflow_cutoff -708.3964185322641
+#define exp_overflow_cutoff 700.0
+#define log2_e 1.4426950408889634
+#define ln2_high 0.693145751953125
+#define ln2_low 1.4286068203094173e-06
+#define round_magic 6755399441055744.0
+
+double exp_polynomial(double r) {
+    /* Degree 13 Taylor polynomial of exp around 0, on |r| <= ln(2)/2 its truncation error is below 1e-17 relative.
+    Input:
+        - double r: Reduced argument.
+    Returns:
+        exp(r) up to rounding.
+    */
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    return p * r + 1.0;
+}
+
+
+void exp_batch_scalar(double *values, int count) {
+    /* Portable version of exp_batch, exp(x) = 2^n * exp(r) with n = round(x / ln(2)) and |r| <= ln(2)/2.
+    Input:
+        - double values[]: Arguments, replaced by their exponentials.
+        - int count: Number of values.
+    */
+    int i;
+    double n;
+    for (i = 0; i < count; i++) {
+        if (values[i] < exp_underflow_cutoff) {
+            values[i] = 0.0;
+        }
+        else if (values[i] > exp_overflow_cutoff) {
+            values[i] = exp(values[i]);
+        }
+        else {
+            n = floor(values[i] * log2_e + 0.5);
+            values[i] = ldexp(exp_polynomial((values[i] - n * ln2_high) - n * ln2_low), (int)n);
+        }
+    }
+}
+
+
+#ifdef fastexp_x86
+__attribute__((target("avx2,fma"))) void exp_batch_avx2(double *values, int count) {
+    /* AVX2/FMA version of exp_batch, evaluates four exponentials at a time with the same reduction and polynomial as exp_batch_scalar.
+       2^n is built directly in the exponent bits, groups that are entirely below the underflow cutoff skip the polynomial altogether.
+    Input:
+        - double values[]: Arguments, replaced by their exponentials.
+        - int count: Number of values.
+    */
+    int i;
+    __m256d x, n, r, p, underflow;
+    __m256i exponent;
+    const __m256d cutoff = _mm256_set1_pd(exp_underflow_cutoff);
+    const __m256d overflow = _mm256_set1_pd(exp_overflow_cutoff);
+    const __m256d magic = _mm256_set1_pd(round_magic);
+    const __m256d biased_magic = _mm256_set1_pd(round_magic + 1023.0);
+    for (i = 0; i + 4 <= count; i += 4) {
+        x = _mm256_loadu_pd(values + i);
+        underflow = _mm256_cmp_pd(x, cutoff, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(underflow) == 0xf) {
+            _mm256_storeu_pd(values + i, _mm256_setzero_pd());
+            continue;
+        }
+        if (_mm256_movemask_pd(_mm256_cmp_pd(x, overflow, _CMP_GT_OQ)) != 0) {
+            exp_batch_scalar(values + i, 4);
+            continue;
+        }
+        n = _mm256_sub_pd(_mm256_fmadd_pd(x, _mm256_set1_pd(log2_e), magic), magic); /* Round to nearest integer */
+        r = _mm256_fnmadd_pd(n, _mm256_set1_pd(ln2_high), x);
+        r = _mm256_fnmadd_pd(n, _mm256_set1_pd(ln2_low), r);
+        p = _mm256_set1_pd(1.0 / 6227020800.0);
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 479001600.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 39916800.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+        /* n + 1023 sits in the low mantissa bits of n + 1023 + magic, shifting it up makes it the exponent of 2^n */
+        exponent = _mm256_slli_epi64(_mm256_castpd_si256(_mm256_add_pd(n, biased_magic)), 52);
+        p = _mm256_mul_pd(p, _mm256_castsi256_pd(exponent));
+        _mm256_storeu_pd(values + i, _mm256_blendv_pd(p, _mm256_setzero_pd(), underflow));
+    }
+    exp_batch_scalar(values + i, count - i);
+}
+#endif
+
+
+void exp_batch(double *values, int count, int exact) {
+    /* Replaces every value with its exponential, used for whole rows of the similarity matrix at once.
+       Unless exact is set, values are evaluated with a vectorized polynomial kernel (AVX2/FMA when the CPU supports it,
+       portable C otherwise) whose maximum relative error against libm is 2^-52 (about 2.2e-16, 1 ulp). Exponentials that would be
+       subnormal (arguments below -708.39) are flushed to zero, which is what most of the similarity matrix is for spread out data.
+       In exact mode libm's exp is used, only arguments whose exponential is exactly zero in double precision are skipped.
+    Input:
+        - double values[]: Arguments, replaced by their exponentials.
+        - int count: Number of values.
+        - int exact: If nonzero every value goes through libm's exp (bit exact runs), otherwise the vectorized kernel is used.
+    */
+    int i;
+    if (exact) {
+        for (i = 0; i < count; i++) {
+            values[i] = (values[i] < -745.2) ? 0.0 : exp(values[i]);
+        }
+        return;
+    }
+#ifdef fastexp_x86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        exp_batch_avx2(values, count);
+        return;
+    }
+#endif
+    exp_batch_scalar(values, count);
+}
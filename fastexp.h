@@ -0,0 +1,7 @@
+double exp_polynomial(double r);
+
+void exp_batch_scalar(double *values, int count);
+
+void exp_batch_avx2(double *values, int count);
+
+void exp_batch(double *values, int count, int exact);
@@ -0,0 +1,58 @@
+#include "gemm.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define gemm_x86 1
+#endif
+
+/* Double precision, the tile is gemm_mr x 8 */
+#define real double
+#define real_a double
+#define precision_function(name) name
+#define kernel_function(name) name
+#define gemm_nr 8
+#define vector256 __m256d
+#define lanes256 4
+#define zero256 _mm256_setzero_pd
+#define load256 _mm256_loadu_pd
+#define store256 _mm256_storeu_pd
+#define broadcast256 _mm256_broadcast_sd
+#define fmadd256 _mm256_fmadd_pd
+#define vector512 __m512d
+#define zero512 _mm512_setzero_pd
+#define load512 _mm512_loadu_pd
+#define store512 _mm512_storeu_pd
+#define set512 _mm512_set1_pd
+#define fmadd512 _mm512_fmadd_pd
+#define add512 _mm512_add_pd
+#include "gemm_template.c"
+
+/* Single precision, twice as many lanes per register so the tile is gemm_mr x 16 */
+#define real float
+#define real_a float
+#define precision_function(name) name ## _f32
+#define kernel_function(name) name ## _f32
+#define gemm_nr 16
+#define vector256 __m256
+#define lanes256 8
+#define zero256 _mm256_setzero_ps
+#define load256 _mm256_loadu_ps
+#define store256 _mm256_storeu_ps
+#define broadcast256 _mm256_broadcast_ss
+#define fmadd256 _mm256_fmadd_ps
+#define vector512 __m512
+#define zero512 _mm512_setzero_ps
+#define load512 _mm512_loadu_ps
+#define store512 _mm512_storeu_ps
+#define set512 _mm512_set1_ps
+#define fmadd512 _mm512_fmadd_ps
+#define add512 _mm512_add_ps
+#include "gemm_template.c"
+
+/* Mixed precision, A stored as float is widened while it is packed and multiplied by the double kernels */
+#define real double
+#define real_a float
+#define precision_function(name) name ## _mixed
+#define kernel_function(name) name
+#define mixed_precision
+#define gemm_nr 8
+#include "gemm_template.c"
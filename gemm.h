@@ -0,0 +1,42 @@
+#define gemm_mr 4
+#define gemm_mc 64
+#define gemm_kc 128
+#define gemm_nc 64
+/* Values of scratch a gemm call packs op(A), B and a micro tile into, in its own element type, enough for either precision's tile width */
+#define gemm_scratch_size (gemm_mc * gemm_kc + gemm_kc * gemm_nc + gemm_mr * 16)
+
+typedef void (*gemm_kernel)(int p, const double *a_panel, const double *b_panel, double *tile);
+
+void gemm_pack_a(double **a, int a_row, int a_col, int transpose_a, int m, int p, double *packed);
+
+void gemm_pack_b(double **b, int b_row, int b_col, int p, int n, double *packed);
+
+void gemm_kernel_scalar(int p, const double *a_panel, const double *b_panel, double *tile);
+
+void gemm_kernel_avx2(int p, const double *a_panel, const double *b_panel, double *tile);
+
+void gemm_kernel_avx512(int p, const double *a_panel, const double *b_panel, double *tile);
+
+gemm_kernel gemm_kernel_selection(void);
+
+void gemm(double **a, int a_row, int a_col, int transpose_a, double **b, int b_row, double **c, int c_row, int m, int p, int n, double *scratch);
+
+typedef void (*gemm_kernel_f32)(int p, const float *a_panel, const float *b_panel, float *tile);
+
+void gemm_pack_a_f32(float **a, int a_row, int a_col, int transpose_a, int m, int p, float *packed);
+
+void gemm_pack_b_f32(float **b, int b_row, int b_col, int p, int n, float *packed);
+
+void gemm_kernel_scalar_f32(int p, const float *a_panel, const float *b_panel, float *tile);
+
+void gemm_kernel_avx2_f32(int p, const float *a_panel, const float *b_panel, float *tile);
+
+void gemm_kernel_avx512_f32(int p, const float *a_panel, const float *b_panel, float *tile);
+
+gemm_kernel_f32 gemm_kernel_selection_f32(void);
+
+void gemm_f32(float **a, int a_row, int a_col, int transpose_a, float **b, int b_row, float **c, int c_row, int m, int p, int n, float *scratch);
+
+void gemm_pack_a_mixed(float **a, int a_row, int a_col, int transpose_a, int m, int p, double *packed);
+
+void gemm_mixed(float **a, int a_row, int a_col, int transpose_a, double **b, int b_row, double **c, int c_row, int m, int p, int n, double *scratch);
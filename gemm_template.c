@@ -0,0 +1,255 @@
+/* Type generic source of gemm.c, included once per precision. The includer defines:
+    - real: Element type of B and C, and of the arithmetic.
+    - real_a: Element type A is stored in, converted to real while it is packed.
+    - precision_function(name): Name of the instantiation of a function taking A (gemm_pack_a and gemm).
+    - kernel_function(name): Name of the instantiation of a function that only sees real (gemm_pack_b and the micro kernels).
+    - mixed_precision: Defined when real_a differs from real, only the functions taking A are emitted and they reuse the kernels of real.
+    - gemm_nr: Columns per micro kernel tile, two AVX2 registers or one AVX-512 register of real.
+    - vector256, lanes256, zero256, load256, store256, broadcast256, fmadd256: AVX2 type, width and intrinsics for real.
+    - vector512, zero512, load512, store512, set512, fmadd512, add512: AVX-512 type and intrinsics for real.
+   All of them are undefined again at the end. */
+
+
+void precision_function(gemm_pack_a)(real_a **a, int a_row, int a_col, int transpose_a, int m, int p, real *packed) {
+    /* Copies an mxp block of op(A) into panels of gemm_mr rows, each panel stored depth by depth (gemm_mr consecutive values per depth)
+       so the micro kernel reads it sequentially. Rows past m are zero padded.
+    Input:
+        - real_a a[][]: Matrix A, any row pointer matrix (including a triangular one, as long as only stored entries are in the block).
+        - int a_row, int a_col: Position of the block's first entry in A.
+        - int transpose_a: If nonzero the block is taken from A^T, entry (i, l) of the block is then a[a_row + l][a_col + i].
+        - int m, int p: Number of rows and depth of the block.
+        - real packed[]: Buffer of at least ceil(m / gemm_mr) * gemm_mr * p values.
+    */
+    int panel, r, l, i;
+    for (panel = 0; panel < m; panel += gemm_mr) {
+        for (l = 0; l < p; l++) {
+            for (r = 0; r < gemm_mr; r++) {
+                i = panel + r;
+                if (i >= m) {
+                    *packed++ = 0.0;
+                }
+                else {
+                    *packed++ = transpose_a ? a[a_row + l][a_col + i] : a[a_row + i][a_col + l];
+                }
+            }
+        }
+    }
+}
+
+
+#ifndef mixed_precision
+void kernel_function(gemm_pack_b)(real **b, int b_row, int b_col, int p, int n, real *packed) {
+    /* Copies a pxn block of B into panels of gemm_nr columns, each panel stored depth by depth (gemm_nr consecutive values per depth).
+       Columns past n are zero padded.
+    Input:
+        - real b[][]: Matrix B.
+        - int b_row, int b_col: Position of the block's first entry in B.
+        - int p, int n: Depth and number of columns of the block.
+        - real packed[]: Buffer of at least p * ceil(n / gemm_nr) * gemm_nr values.
+    */
+    int panel, c, l;
+    for (panel = 0; panel < n; panel += gemm_nr) {
+        for (l = 0; l < p; l++) {
+            for (c = 0; c < gemm_nr; c++) {
+                *packed++ = (panel + c < n) ? b[b_row + l][b_col + panel + c] : 0.0;
+            }
+        }
+    }
+}
+
+
+void kernel_function(gemm_kernel_scalar)(int p, const real *a_panel, const real *b_panel, real *tile) {
+    /* Portable micro kernel, tile = a_panel * b_panel for one gemm_mr x gemm_nr tile.
+    Input:
+        - int p: Depth of the panels.
+        - const real a_panel[]: Packed gemm_mr x p panel of A.
+        - const real b_panel[]: Packed p x gemm_nr panel of B.
+        - real tile[]: gemm_mr x gemm_nr row major output, overwritten.
+    */
+    int l, r, c;
+    for (r = 0; r < gemm_mr * gemm_nr; r++) {
+        tile[r] = 0.0;
+    }
+    for (l = 0; l < p; l++) {
+        for (r = 0; r < gemm_mr; r++) {
+            for (c = 0; c < gemm_nr; c++) {
+                tile[r * gemm_nr + c] += a_panel[l * gemm_mr + r] * b_panel[l * gemm_nr + c];
+            }
+        }
+    }
+}
+
+
+#ifdef gemm_x86
+__attribute__((target("avx2,fma"))) void kernel_function(gemm_kernel_avx2)(int p, const real *a_panel, const real *b_panel, real *tile) {
+    /* AVX2/FMA version of gemm_kernel_scalar, the whole tile lives in eight registers (two per row) for the length of the panels.
+    Input:
+        - int p: Depth of the panels.
+        - const real a_panel[]: Packed gemm_mr x p panel of A.
+        - const real b_panel[]: Packed p x gemm_nr panel of B.
+        - real tile[]: gemm_mr x gemm_nr row major output, overwritten.
+    */
+    int l;
+    vector256 b_low, b_high, a_value;
+    vector256 c00 = zero256(), c01 = zero256(), c10 = zero256(), c11 = zero256();
+    vector256 c20 = zero256(), c21 = zero256(), c30 = zero256(), c31 = zero256();
+    for (l = 0; l < p; l++) {
+        b_low = load256(b_panel);
+        b_high = load256(b_panel + lanes256);
+        a_value = broadcast256(a_panel);
+        c00 = fmadd256(a_value, b_low, c00);
+        c01 = fmadd256(a_value, b_high, c01);
+        a_value = broadcast256(a_panel + 1);
+        c10 = fmadd256(a_value, b_low, c10);
+        c11 = fmadd256(a_value, b_high, c11);
+        a_value = broadcast256(a_panel + 2);
+        c20 = fmadd256(a_value, b_low, c20);
+        c21 = fmadd256(a_value, b_high, c21);
+        a_value = broadcast256(a_panel + 3);
+        c30 = fmadd256(a_value, b_low, c30);
+        c31 = fmadd256(a_value, b_high, c31);
+        a_panel += gemm_mr;
+        b_panel += gemm_nr;
+    }
+    store256(tile, c00);
+    store256(tile + lanes256, c01);
+    store256(tile + gemm_nr, c10);
+    store256(tile + gemm_nr + lanes256, c11);
+    store256(tile + 2 * gemm_nr, c20);
+    store256(tile + 2 * gemm_nr + lanes256, c21);
+    store256(tile + 3 * gemm_nr, c30);
+    store256(tile + 3 * gemm_nr + lanes256, c31);
+}
+
+
+__attribute__((target("avx512f"))) void kernel_function(gemm_kernel_avx512)(int p, const real *a_panel, const real *b_panel, real *tile) {
+    /* AVX-512 version of gemm_kernel_scalar, a row of the tile fits a single register. Two depths are processed per step into separate
+       accumulators so that eight independent FMA chains are in flight, they are summed once at the end.
+    Input:
+        - int p: Depth of the panels.
+        - const real a_panel[]: Packed gemm_mr x p panel of A.
+        - const real b_panel[]: Packed p x gemm_nr panel of B.
+        - real tile[]: gemm_mr x gemm_nr row major output, overwritten.
+    */
+    int l;
+    vector512 b_even, b_odd;
+    vector512 c0 = zero512(), c1 = zero512(), c2 = zero512(), c3 = zero512();
+    vector512 d0 = zero512(), d1 = zero512(), d2 = zero512(), d3 = zero512();
+    for (l = 0; l + 2 <= p; l += 2) {
+        b_even = load512(b_panel);
+        b_odd = load512(b_panel + gemm_nr);
+        c0 = fmadd512(set512(a_panel[0]), b_even, c0);
+        c1 = fmadd512(set512(a_panel[1]), b_even, c1);
+        c2 = fmadd512(set512(a_panel[2]), b_even, c2);
+        c3 = fmadd512(set512(a_panel[3]), b_even, c3);
+        d0 = fmadd512(set512(a_panel[4]), b_odd, d0);
+        d1 = fmadd512(set512(a_panel[5]), b_odd, d1);
+        d2 = fmadd512(set512(a_panel[6]), b_odd, d2);
+        d3 = fmadd512(set512(a_panel[7]), b_odd, d3);
+        a_panel += 2 * gemm_mr;
+        b_panel += 2 * gemm_nr;
+    }
+    if (l < p) {
+        b_even = load512(b_panel);
+        c0 = fmadd512(set512(a_panel[0]), b_even, c0);
+        c1 = fmadd512(set512(a_panel[1]), b_even, c1);
+        c2 = fmadd512(set512(a_panel[2]), b_even, c2);
+        c3 = fmadd512(set512(a_panel[3]), b_even, c3);
+    }
+    store512(tile, add512(c0, d0));
+    store512(tile + gemm_nr, add512(c1, d1));
+    store512(tile + 2 * gemm_nr, add512(c2, d2));
+    store512(tile + 3 * gemm_nr, add512(c3, d3));
+}
+#endif
+
+
+kernel_function(gemm_kernel) kernel_function(gemm_kernel_selection)(void) {
+    /* Picks the widest micro kernel the CPU running us supports.
+    Returns:
+        AVX-512, AVX2/FMA or portable micro kernel.
+    */
+#ifdef gemm_x86
+    if (__builtin_cpu_supports("avx512f")) {
+        return kernel_function(gemm_kernel_avx512);
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return kernel_function(gemm_kernel_avx2);
+    }
+#endif
+    return kernel_function(gemm_kernel_scalar);
+}
+
+
+#endif
+
+
+void precision_function(gemm)(real_a **a, int a_row, int a_col, int transpose_a, real **b, int b_row, real **c, int c_row, int m, int p, int n, real *scratch) {
+    /* Adds op(A) * B to C, C[c_row + i][j] += sum over l of op(A)(i, l) * b[b_row + l][j] for i < m, j < n, l < p.
+       Cache blocked: B is packed gemm_kc x gemm_nc at a time and op(A) gemm_mc x gemm_kc at a time into the caller's scratch, small enough
+       to stay in cache, then every gemm_mr x gemm_nr tile of C is computed by a vectorized micro kernel chosen at runtime. Packing also makes
+       taking the block from A^T cost the same as from A. Does not allocate memory, and the buffers are not on the stack either since
+       together they would take up most of a small thread stack.
+    Input:
+        - real_a a[][]: Matrix A, row pointers (a triangular matrix works as long as the block only covers stored entries).
+        - int a_row, int a_col: Position in A of op(A)'s first entry, before transposition.
+        - int transpose_a: If nonzero A^T is used, op(A)(i, l) = a[a_row + l][a_col + i], otherwise op(A)(i, l) = a[a_row + i][a_col + l].
+        - real b[][]: Matrix B, only columns 0 to n are read.
+        - int b_row: Row of B multiplying op(A)'s first column.
+        - real c[][]: Matrix C, only columns 0 to n are updated.
+        - int c_row: Row of C receiving op(A)'s first row.
+        - int m, int p, int n: op(A) is mxp, B's block is pxn.
+        - real scratch[]: gemm_scratch_size values of scratch, no two concurrent calls may share it.
+    */
+    real *a_packed = scratch, *b_packed = scratch + gemm_mc * gemm_kc, *tile = b_packed + gemm_kc * gemm_nc;
+    int i0, l0, j0, i, j, r, s, block_m, block_p, block_n;
+    kernel_function(gemm_kernel) kernel = kernel_function(gemm_kernel_selection)();
+    for (j0 = 0; j0 < n; j0 += gemm_nc) {
+        block_n = (n - j0 < gemm_nc) ? n - j0 : gemm_nc;
+        for (l0 = 0; l0 < p; l0 += gemm_kc) {
+            block_p = (p - l0 < gemm_kc) ? p - l0 : gemm_kc;
+            kernel_function(gemm_pack_b)(b, b_row + l0, j0, block_p, block_n, b_packed);
+            for (i0 = 0; i0 < m; i0 += gemm_mc) {
+                block_m = (m - i0 < gemm_mc) ? m - i0 : gemm_mc;
+                if (transpose_a) {
+                    precision_function(gemm_pack_a)(a, a_row + l0, a_col + i0, 1, block_m, block_p, a_packed);
+                }
+                else {
+                    precision_function(gemm_pack_a)(a, a_row + i0, a_col + l0, 0, block_m, block_p, a_packed);
+                }
+                for (j = 0; j < block_n; j += gemm_nr) {
+                    for (i = 0; i < block_m; i += gemm_mr) {
+                        kernel(block_p, a_packed + i * block_p, b_packed + j * block_p, tile);
+                        for (r = 0; r < gemm_mr && i + r < block_m; r++) {
+                            for (s = 0; s < gemm_nr && j + s < block_n; s++) {
+                                c[c_row + i0 + i + r][j0 + j + s] += tile[r * gemm_nr + s];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+#undef real
+#undef real_a
+#undef precision_function
+#undef kernel_function
+#undef mixed_precision
+#undef gemm_nr
+#undef vector256
+#undef lanes256
+#undef zero256
+#undef load256
+#undef store256
+#undef broadcast256
+#undef fmadd256
+#undef vector512
+#undef zero512
+#undef load512
+#undef store512
+#undef set512
+#undef fmadd512
+#undef add512
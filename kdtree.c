@@ -0,0 +1,263 @@
+#include <math.h>
+#include <stdlib.h>
+#include "sym.h"
+#include "sparse.h"
+#include "kdtree.h"
+#define kd_leaf_size 16
+
+
+void kd_tree_select(double **datapoints, int *indices, int start, int end, int nth, int dimension) {
+    /* Reorders indices[start:end] (quickselect) so that indices[nth] is the point whose coordinate in the given dimension would be at position nth
+       if the range was sorted by it, every point before it has a coordinate that is not larger and every point after it one that is not smaller.
+    Input:
+        - double datapoints[][]: 2D Array of points the indices refer to.
+        - int indices[]: Point indices being reordered.
+        - int start, int end: Range of indices being reordered.
+        - int nth: Position within [start, end) whose point we are selecting.
+        - int dimension: Coordinate points are compared by.
+    */
+    int low = start, high = end - 1;
+    int i, j, temp;
+    double pivot;
+    while (low < high) {
+        pivot = datapoints[indices[low + (high - low) / 2]][dimension];
+        i = low;
+        j = high;
+        while (i <= j) {
+            while (datapoints[indices[i]][dimension] < pivot) i++;
+            while (datapoints[indices[j]][dimension] > pivot) j--;
+            if (i <= j) {
+                temp = indices[i];
+                indices[i++] = indices[j];
+                indices[j--] = temp;
+            }
+        }
+        if (nth <= j) {
+            high = j;
+        }
+        else if (nth >= i) {
+            low = i;
+        }
+        else {
+            return;
+        }
+    }
+}
+
+
+int kd_tree_build_node(kd_tree *tree, int start, int end) {
+    /* Recursively builds the subtree holding points indices[start:end], splitting at the median of the coordinate with the largest spread.
+    Input:
+        - kd_tree *tree: Tree being built, its nodes array must have room for the new nodes.
+        - int start, int end: Range of indices covered by the subtree.
+    Returns:
+        Index of the subtree's root in tree->nodes.
+    */
+    int node = tree->num_nodes++;
+    int i, l, middle, split_dimension = 0;
+    double low, high, spread = 0.0;
+    tree->nodes[node].start = start;
+    tree->nodes[node].end = end;
+    tree->nodes[node].left = -1;
+    tree->nodes[node].right = -1;
+    if (end - start <= kd_leaf_size) {
+        return node;
+    }
+    for (l = 0; l < tree->dimension; l++) {
+        low = high = tree->datapoints[tree->indices[start]][l];
+        for (i = start + 1; i < end; i++) {
+            if (tree->datapoints[tree->indices[i]][l] < low) low = tree->datapoints[tree->indices[i]][l];
+            if (tree->datapoints[tree->indices[i]][l] > high) high = tree->datapoints[tree->indices[i]][l];
+        }
+        if (high - low > spread) {
+            spread = high - low;
+            split_dimension = l;
+        }
+    }
+    if (spread == 0.0) {
+        return node; /* All points in the range are identical, nothing to split by */
+    }
+    middle = start + (end - start) / 2;
+    kd_tree_select(tree->datapoints, tree->indices, start, end, middle, split_dimension);
+    tree->nodes[node].split_dimension = split_dimension;
+    tree->nodes[node].split_value = tree->datapoints[tree->indices[middle]][split_dimension];
+    tree->nodes[node].left = kd_tree_build_node(tree, start, middle);
+    tree->nodes[node].right = kd_tree_build_node(tree, middle, end);
+    return node;
+}
+
+
+kd_tree *kd_tree_creation(double **datapoints, int num_points, int point_dimension) {
+    /* Builds a KD-tree over the given points in O(n log n), used to find neighbours without comparing every pair of points. Returns NULL on error.
+       The tree refers to datapoints without copying them, so they must outlive it.
+    Input:
+        - double datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points.
+        - int point_dimension: Number of coordinates in each point.
+    Returns:
+        KD-tree whose root is tree->nodes[0].
+    */
+    int i;
+    kd_tree *tree = malloc(sizeof(kd_tree));
+    if (tree == NULL) {
+        return NULL;
+    }
+    tree->datapoints = datapoints;
+    tree->num_points = num_points;
+    tree->dimension = point_dimension;
+    tree->num_nodes = 0;
+    tree->indices = malloc(num_points * sizeof(int));
+    tree->nodes = malloc(2 * num_points * sizeof(kd_node)); /* Every node holds at least one point and splits in two, so there are less than 2n */
+    if (tree->indices == NULL || tree->nodes == NULL) {
+        free_kd_tree(tree);
+        return NULL;
+    }
+    for (i = 0; i < num_points; i++) {
+        tree->indices[i] = i;
+    }
+    kd_tree_build_node(tree, 0, num_points);
+    return tree;
+}
+
+
+void free_kd_tree(kd_tree *tree) {
+    /* Frees up KD-tree memory (the datapoints it refers to are not freed).
+    Input:
+        - kd_tree *tree: Tree whose memory we are freeing, can be NULL.
+    */
+    if (tree == NULL) return;
+    free(tree->indices);
+    free(tree->nodes);
+    free(tree);
+}
+
+
+void kd_tree_nearest_search(kd_tree *tree, int node, int query, int neighbours, double *keys, int *ids, int *size) {
+    /* Recursively searches a subtree for the nearest neighbours of a point, keeping them in a bounded max-heap of squared distances.
+       The side of the split containing the query is searched first, the other side only if it can hold a closer point than the current farthest one.
+    Input:
+        - kd_tree *tree: Tree being searched.
+        - int node: Root of the searched subtree.
+        - int query: Index of the point whose neighbours we are looking for, it is never its own neighbour.
+        - int neighbours: Number of nearest neighbours kept.
+        - double keys[], int ids[]: Heap of the squared distances and indices of the neighbours found so far.
+        - int *size: Number of neighbours currently in the heap.
+    */
+    int i, point, near_child, far_child;
+    double difference, distance_squared;
+    double *query_point = tree->datapoints[query];
+    kd_node *current = &tree->nodes[node];
+    if (current->left == -1) {
+        for (i = current->start; i < current->end; i++) {
+            point = tree->indices[i];
+            if (point == query) continue;
+            distance_squared = euclidean_distance_squared(query_point, tree->datapoints[point], tree->dimension);
+            if (*size < neighbours) {
+                keys[*size] = distance_squared;
+                ids[*size] = point;
+                heap_sift_up(keys, ids, (*size)++);
+            }
+            else if (distance_squared < keys[0]) {
+                keys[0] = distance_squared;
+                ids[0] = point;
+                heap_sift_down(keys, ids, *size, 0);
+            }
+        }
+        return;
+    }
+    difference = query_point[current->split_dimension] - current->split_value;
+    near_child = (difference < 0.0) ? current->left : current->right;
+    far_child = (difference < 0.0) ? current->right : current->left;
+    kd_tree_nearest_search(tree, near_child, query, neighbours, keys, ids, size);
+    if (*size < neighbours || difference * difference < keys[0]) {
+        kd_tree_nearest_search(tree, far_child, query, neighbours, keys, ids, size);
+    }
+}
+
+
+int kd_tree_radius_search(kd_tree *tree, int node, int query, double radius_squared, edge_list *edges) {
+    /* Recursively searches a subtree for the points j > query within the given radius of the query point, appending an edge
+       (valued by its similarity) for each of them. Returns 1 on success and 0 on error.
+    Input:
+        - kd_tree *tree: Tree being searched.
+        - int node: Root of the searched subtree.
+        - int query: Index of the point whose neighbourhood we are looking for.
+        - double radius_squared: Squared radius of the neighbourhood.
+        - edge_list *edges: List the edges are appended to.
+    */
+    int i, point;
+    double difference, distance_squared;
+    double *query_point = tree->datapoints[query];
+    kd_node *current = &tree->nodes[node];
+    if (current->left == -1) {
+        for (i = current->start; i < current->end; i++) {
+            point = tree->indices[i];
+            if (point <= query) continue;
+            distance_squared = euclidean_distance_squared(query_point, tree->datapoints[point], tree->dimension);
+            if (distance_squared <= radius_squared && !edge_list_append(edges, query, point, exp(-(distance_squared / 2.0)))) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+    difference = query_point[current->split_dimension] - current->split_value;
+    if ((difference <= 0.0 || difference * difference <= radius_squared) && !kd_tree_radius_search(tree, current->left, query, radius_squared, edges)) {
+        return 0;
+    }
+    if ((difference >= 0.0 || difference * difference <= radius_squared) && !kd_tree_radius_search(tree, current->right, query, radius_squared, edges)) {
+        return 0;
+    }
+    return 1;
+}
+
+
+int kd_tree_nearest_neighbour_edges(kd_tree *tree, int neighbours, double threshold, edge_list *edges) {
+    /* Same as nearest_neighbour_edges, with every point's neighbours found through the tree. Returns 1 on success and 0 on error.
+    Input:
+        - kd_tree *tree: Tree over the points.
+        - int neighbours: Number of nearest neighbours kept per point.
+        - double threshold: Edges whose similarity is below threshold are dropped, 0 keeps every neighbour.
+        - edge_list *edges: List the edges (with their similarity as value) are appended to.
+    */
+    int i, j, size;
+    double value;
+    double *keys = malloc(neighbours * sizeof(double));
+    int *ids = malloc(neighbours * sizeof(int));
+    if (keys == NULL || ids == NULL) {
+        free(keys);
+        free(ids);
+        return 0;
+    }
+    for (i = 0; i < tree->num_points; i++) {
+        size = 0;
+        kd_tree_nearest_search(tree, 0, i, neighbours, keys, ids, &size);
+        for (j = 0; j < size; j++) {
+            value = exp(-(keys[j] / 2.0));
+            if (value >= threshold && !edge_list_append(edges, i, ids[j], value)) {
+                free(keys);
+                free(ids);
+                return 0;
+            }
+        }
+    }
+    free(keys);
+    free(ids);
+    return 1;
+}
+
+
+int kd_tree_threshold_edges(kd_tree *tree, double threshold, edge_list *edges) {
+    /* Same as threshold_edges, a similarity of at least threshold is a radius search of radius sqrt(-2 ln(threshold)). Returns 1 on success and 0 on error.
+    Input:
+        - kd_tree *tree: Tree over the points.
+        - double threshold: Smallest similarity that is kept, must be positive.
+        - edge_list *edges: List the edges (with their similarity as value) are appended to.
+    */
+    int i;
+    for (i = 0; i < tree->num_points; i++) {
+        if (!kd_tree_radius_search(tree, 0, i, -2.0 * log(threshold), edges)) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,33 @@
+typedef struct kd_node {
+    int start;
+    int end;
+    int split_dimension;
+    double split_value;
+    int left;
+    int right;
+} kd_node;
+
+typedef struct kd_tree {
+    double **datapoints;
+    int *indices;
+    kd_node *nodes;
+    int num_nodes;
+    int num_points;
+    int dimension;
+} kd_tree;
+
+void kd_tree_select(double **datapoints, int *indices, int start, int end, int nth, int dimension);
+
+int kd_tree_build_node(kd_tree *tree, int start, int end);
+
+kd_tree *kd_tree_creation(double **datapoints, int num_points, int point_dimension);
+
+void free_kd_tree(kd_tree *tree);
+
+void kd_tree_nearest_search(kd_tree *tree, int node, int query, int neighbours, double *keys, int *ids, int *size);
+
+int kd_tree_radius_search(kd_tree *tree, int node, int query, double radius_squared, edge_list *edges);
+
+int kd_tree_nearest_neighbour_edges(kd_tree *tree, int neighbours, double threshold, edge_list *edges);
+
+int kd_tree_threshold_edges(kd_tree *tree, double threshold, edge_list *edges);
@@ -0,0 +1,231 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "utils.h"
+#include "sym.h"
+#include "norm.h"
+#include "gemm.h"
+#include "parallel.h"
+#include "mapped.h"
+#define mapped_block_size 64
+#define mapped_file_template "/symnmf-XXXXXX"
+
+
+mapped_matrix *mapped_matrix_creation(const char *directory, int n) {
+    /* Creates a packed upper triangular nxn matrix like triangular_matrix_creation, but backed by a memory mapped file instead of the heap,
+       so that it can be larger than memory and the operating system pages it in and out as it is used. The file is unlinked as soon as it
+       is created, it disappears once the matrix is freed or the process ends. The file's blocks are reserved up front rather than left
+       sparse, so a full disk fails here instead of killing the process with SIGBUS on the first write to a page it has no room for.
+       Returns NULL on error.
+    Input:
+        - const char *directory: Directory the backing file is created in, it needs n(n+1)/2 doubles of free space.
+        - int n: Number of rows and columns in the symmetric matrix.
+    Returns:
+        Mapped matrix whose rows have the same layout as triangular_matrix_creation's, all stored elements are zero (freshly reserved blocks read as zeros).
+    */
+    int i, descriptor;
+    char *path;
+    mapped_matrix *matrix = malloc(sizeof(mapped_matrix));
+    if (matrix == NULL) {
+        return NULL;
+    }
+    matrix->n = n;
+    matrix->size = (size_t)n * (n + 1) / 2 * sizeof(double);
+    matrix->rows = malloc(n * sizeof(double *));
+    path = malloc(strlen(directory) + strlen(mapped_file_template) + 1);
+    if (matrix->rows == NULL || path == NULL) {
+        free(matrix->rows);
+        free(matrix);
+        free(path);
+        return NULL;
+    }
+    strcpy(path, directory);
+    strcat(path, mapped_file_template);
+    descriptor = mkstemp(path);
+    if (descriptor >= 0) {
+        unlink(path);
+    }
+    free(path);
+    if (descriptor < 0 || posix_fallocate(descriptor, 0, (off_t)matrix->size) != 0) {
+        if (descriptor >= 0) close(descriptor);
+        free(matrix->rows);
+        free(matrix);
+        return NULL;
+    }
+    matrix->mapping = mmap(NULL, matrix->size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor); /* The mapping keeps the file alive */
+    if (matrix->mapping == MAP_FAILED) {
+        free(matrix->rows);
+        free(matrix);
+        return NULL;
+    }
+    posix_madvise(matrix->mapping, matrix->size, POSIX_MADV_SEQUENTIAL); /* Every pass over the matrix goes row after row */
+    for (i = 0; i < n; i++) {
+        matrix->rows[i] = (double *)matrix->mapping + (size_t)i * n - (size_t)i * (i + 1) / 2;
+    }
+    return matrix;
+}
+
+
+void free_mapped_matrix(mapped_matrix *matrix) {
+    /* Frees up mapped matrix memory by unmapping its file (which deletes it) and freeing its row pointers.
+    Input:
+        - mapped_matrix *matrix: Matrix whose memory we are freeing, can be NULL.
+    */
+    if (matrix == NULL) return;
+    munmap(matrix->mapping, matrix->size);
+    free(matrix->rows);
+    free(matrix);
+}
+
+
+void mapped_matrix_prefetch(mapped_matrix *matrix, int row_start, int row_end) {
+    /* Asks the operating system to start reading rows [row_start, row_end) of a mapped matrix from disk, without waiting for them.
+    Input:
+        - mapped_matrix *matrix: Mapped matrix.
+        - int row_start, int row_end: Rows to prefetch, clipped to the matrix.
+    */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), start, end;
+    if (row_end > matrix->n) {
+        row_end = matrix->n;
+    }
+    if (row_start >= row_end) {
+        return;
+    }
+    start = (size_t)((char *)(matrix->rows[row_start] + row_start) - matrix->mapping);
+    end = (size_t)((char *)(matrix->rows[row_end - 1] + matrix->n) - matrix->mapping);
+    start -= start % page; /* posix_madvise wants a page aligned address */
+    posix_madvise(matrix->mapping + start, end - start, POSIX_MADV_WILLNEED);
+}
+
+
+mapped_matrix *mapped_similarity_matrix(double **datapoints, int num_points, int point_dimension, const char *directory, double *degrees, int exact_exp) {
+    /* Creates the similarity matrix straight into a memory mapped file, see similarity_matrix_with_degrees. Returns NULL on error.
+    Input:
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points in Datapoints, this is also the size of the similarity matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - const char *directory: Directory the backing file is created in.
+        - double degrees[]: Zero instantiated array of num_points, entry i ends up holding the sum of row i. Can be NULL if row sums aren't needed.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    Returns:
+        Mapped similarity matrix
+    */
+    mapped_matrix *sym_matrix = mapped_matrix_creation(directory, num_points);
+    if (sym_matrix == NULL) {
+        return NULL;
+    }
+    if (similarity_matrix_fill(datapoints, sym_matrix->rows, num_points, point_dimension, degrees, exact_exp) != 0) {
+        free_mapped_matrix(sym_matrix);
+        return NULL;
+    }
+    return sym_matrix;
+}
+
+
+mapped_matrix *mapped_norm_matrix(double **datapoints, int num_points, int point_dimension, const char *directory, int exact_exp) {
+    /* Creates the norm matrix straight into a memory mapped file, see fused_norm_matrix. Returns NULL on error.
+    Input:
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points in Datapoints, this is also the size of the norm matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - const char *directory: Directory the backing file is created in.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    Returns:
+        Mapped norm matrix W
+    */
+    mapped_matrix *normal_matrix;
+    double *degrees = calloc(num_points, sizeof(double));
+    if (degrees == NULL) {
+        return NULL;
+    }
+    normal_matrix = mapped_similarity_matrix(datapoints, num_points, point_dimension, directory, degrees, exact_exp);
+    if (normal_matrix != NULL) {
+        norm_matrix(normal_matrix->rows, degrees, num_points);
+    }
+    free(degrees);
+    return normal_matrix;
+}
+
+
+void mapped_matrix_multiplication(mapped_matrix *matrix, double **H, double **result_matrix, double **partial_products, double *gemm_scratch, int threads, int k) {
+    /* Multiplies a mapped symmetric matrix by a regular matrix reading the matrix exactly once, in file order, so that a matrix larger than
+       memory is streamed from disk once per multiplication instead of paged in at random. Block row I is read whole: its diagonal block is
+       done directly and every block A_IJ after it contributes A_IJ * H_J to rows I and A_IJ^T * H_I to rows J through gemm. The next block
+       row is prefetched while the current one is multiplied. Block rows are split between threads, since they all add to rows J each thread
+       accumulates into its own copy of the result, which are added up at the end.
+    Input:
+        - mapped_matrix *matrix: Left nxn symmetric matrix.
+        - double H[][]: Right nxk matrix.
+        - double result_matrix[][]: nxk matrix the result of multiplying the matrices is written to, its previous contents are overwritten.
+        - double partial_products[][]: (threads * n)xk scratch matrix for the threads' copies of the result, can be NULL with a single thread.
+        - double gemm_scratch[]: threads * gemm_scratch_size values of scratch, one gemm_scratch_size slice per thread (a single slice when
+          partial_products is NULL).
+        - int threads: Number of threads to use, the number of copies partial_products has room for. Ignored when partial_products is NULL.
+        - int k: Number of columns in right matrix.
+    */
+    int i, j, c, t, row_block, row_end, col_block, col_end, offset;
+    int n = matrix->n;
+    double entry, *scratch;
+    double **target = (partial_products != NULL) ? partial_products : result_matrix;
+    double **W = matrix->rows;
+    if (partial_products == NULL) {
+        threads = 1;
+    }
+#ifdef _OPENMP
+    #pragma omp parallel private(i, j, c, t, row_end, col_block, col_end, offset, entry, scratch) num_threads(threads)
+#endif
+    {
+        offset = (partial_products != NULL) ? thread_number() * n : 0;
+        scratch = gemm_scratch + (size_t)thread_number() * gemm_scratch_size;
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (i = 0; i < threads * n; i++) { /* Every copy, a nested region may end up with fewer threads than asked for */
+            for (c = 0; c < k; c++) {
+                target[i][c] = 0.0;
+            }
+        }
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (row_block = 0; row_block < n; row_block += mapped_block_size) {
+            row_end = (row_block + mapped_block_size < n) ? row_block + mapped_block_size : n;
+            mapped_matrix_prefetch(matrix, row_end, row_end + mapped_block_size);
+            for (i = row_block; i < row_end; i++) {
+                for (c = 0; c < k; c++) {
+                    target[offset + i][c] += W[i][i] * H[i][c];
+                }
+                for (j = i + 1; j < row_end; j++) {
+                    entry = W[i][j];
+                    for (c = 0; c < k; c++) {
+                        target[offset + i][c] += entry * H[j][c];
+                        target[offset + j][c] += entry * H[i][c];
+                    }
+                }
+            }
+            for (col_block = row_end; col_block < n; col_block += mapped_block_size) {
+                col_end = (col_block + mapped_block_size < n) ? col_block + mapped_block_size : n;
+                gemm(W, row_block, col_block, 0, H, col_block, target, offset + row_block, row_end - row_block, col_end - col_block, k, scratch);
+                gemm(W, row_block, col_block, 1, H, row_block, target, offset + col_block, col_end - col_block, row_end - row_block, k, scratch);
+            }
+        }
+        if (partial_products != NULL) {
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (i = 0; i < n; i++) {
+                for (c = 0; c < k; c++) {
+                    result_matrix[i][c] = 0.0;
+                    for (t = 0; t < threads; t++) {
+                        result_matrix[i][c] += partial_products[t * n + i][c];
+                    }
+                }
+            }
+        }
+    }
+}
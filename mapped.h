@@ -0,0 +1,18 @@
+typedef struct mapped_matrix {
+    double **rows;
+    char *mapping;
+    size_t size;
+    int n;
+} mapped_matrix;
+
+mapped_matrix *mapped_matrix_creation(const char *directory, int n);
+
+void free_mapped_matrix(mapped_matrix *matrix);
+
+void mapped_matrix_prefetch(mapped_matrix *matrix, int row_start, int row_end);
+
+mapped_matrix *mapped_similarity_matrix(double **datapoints, int num_points, int point_dimension, const char *directory, double *degrees, int exact_exp);
+
+mapped_matrix *mapped_norm_matrix(double **datapoints, int num_points, int point_dimension, const char *directory, int exact_exp);
+
+void mapped_matrix_multiplication(mapped_matrix *matrix, double **H, double **result_matrix, double **partial_products, double *gemm_scratch, int threads, int k);
@@ -0,0 +1,58 @@
+#include "mt19937.h"
+#define mt_size 624
+#define mt_shift 397
+#define mt_mask 0xffffffffUL
+
+
+void mt19937_seed(mt19937_state *state, unsigned long seed) {
+    /* Seeds a Mersenne Twister (MT19937) generator the same way numpy's np.random.seed does for an integer seed,
+       so C side draws reproduce the Python side ones.
+    Input:
+        - mt19937_state *state: Generator state being seeded.
+        - unsigned long seed: Seed, only its lower 32 bits are used.
+    */
+    int i;
+    state->mt[0] = seed & mt_mask;
+    for (i = 1; i < mt_size; i++) {
+        state->mt[i] = (1812433253UL * (state->mt[i - 1] ^ (state->mt[i - 1] >> 30)) + i) & mt_mask;
+    }
+    state->index = mt_size;
+}
+
+
+unsigned long mt19937_next(mt19937_state *state) {
+    /* Draws the next 32 bit value of the generator (unsigned long is used as C89 has no fixed width 32 bit type, values are masked to 32 bits).
+    Input:
+        - mt19937_state *state: Seeded generator state.
+    Returns:
+        Uniformly distributed integer in [0, 2^32).
+    */
+    int i;
+    unsigned long y;
+    if (state->index >= mt_size) {
+        for (i = 0; i < mt_size; i++) {
+            y = (state->mt[i] & 0x80000000UL) | (state->mt[(i + 1) % mt_size] & 0x7fffffffUL);
+            state->mt[i] = state->mt[(i + mt_shift) % mt_size] ^ (y >> 1) ^ ((y & 1UL) ? 0x9908b0dfUL : 0UL);
+        }
+        state->index = 0;
+    }
+    y = state->mt[state->index++];
+    y ^= (y >> 11);
+    y ^= (y << 7) & 0x9d2c5680UL;
+    y ^= (y << 15) & 0xefc60000UL;
+    y ^= (y >> 18);
+    return y & mt_mask;
+}
+
+
+double mt19937_uniform(mt19937_state *state) {
+    /* Draws a double with 53 random bits out of two 32 bit draws, the same way numpy's random_sample does.
+    Input:
+        - mt19937_state *state: Seeded generator state.
+    Returns:
+        Uniformly distributed double in [0, 1).
+    */
+    unsigned long a = mt19937_next(state) >> 5;
+    unsigned long b = mt19937_next(state) >> 6;
+    return (a * 67108864.0 + b) / 9007199254740992.0;
+}
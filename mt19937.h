@@ -0,0 +1,10 @@
+typedef struct mt19937_state {
+    unsigned long mt[624];
+    int index;
+} mt19937_state;
+
+void mt19937_seed(mt19937_state *state, unsigned long seed);
+
+unsigned long mt19937_next(mt19937_state *state);
+
+double mt19937_uniform(mt19937_state *state);
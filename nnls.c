@@ -0,0 +1,162 @@
+#include <math.h>
+#include "utils.h"
+#include "nnls.h"
+#define nnls_max_iter 100
+#define nnls_backup_exchanges 3
+
+
+int cholesky_subset_solve(double **gram, double shift, int *indices, int m, double *rhs, double *factor) {
+    /* Solves (C + shift * I)[F, F] * x = b for a subset F of the rows/columns of a symmetric positive definite kxk matrix C, via Cholesky.
+       Returns -1 if the submatrix is not numerically positive definite, 0 otherwise.
+    Input:
+        - double gram[][]: kxk triangular matrix C.
+        - double shift: Added to C's diagonal.
+        - int indices[]: The m indices making up F.
+        - int m: Size of F.
+        - double rhs[]: Right hand side b[F] (m entries), replaced by the solution x[F].
+        - double factor[]: Scratch for the mxm Cholesky factor, at least m * m entries.
+    */
+    int r, c, l;
+    double value;
+    for (r = 0; r < m; r++) {
+        for (c = 0; c <= r; c++) {
+            value = symmetric_entry(gram, indices[r], indices[c]) + ((r == c) ? shift : 0.0);
+            for (l = 0; l < c; l++) {
+                value -= factor[r * m + l] * factor[c * m + l];
+            }
+            if (r == c) {
+                if (value <= 0.0) {
+                    return -1;
+                }
+                factor[r * m + r] = sqrt(value);
+            }
+            else {
+                factor[r * m + c] = value / factor[c * m + c];
+            }
+        }
+    }
+    for (r = 0; r < m; r++) { /* L * z = b */
+        for (l = 0; l < r; l++) {
+            rhs[r] -= factor[r * m + l] * rhs[l];
+        }
+        rhs[r] /= factor[r * m + r];
+    }
+    for (r = m - 1; r >= 0; r--) { /* L^T * x = z */
+        for (l = r + 1; l < m; l++) {
+            rhs[r] -= factor[l * m + r] * rhs[l];
+        }
+        rhs[r] /= factor[r * m + r];
+    }
+    return 0;
+}
+
+
+int nnls_block_pivoting(double **gram, double shift, double *rhs, double *x, int k, double *scratch, int *sets) {
+    /* Solves the nonnegative least squares problem min_{x >= 0} x^T * C * x - 2 * b^T * x, C = gram + shift * I, exactly with block principal
+       pivoting (Kim and Park): a guess of which entries are positive is solved as an unconstrained system, and every entry violating optimality
+       (a negative solved entry, or a zeroed entry whose gradient is negative) switches sides, falling back to switching one entry at a time if
+       the number of violations stops shrinking. Returns -1 on failure (C not numerically positive definite or no convergence), 0 otherwise.
+    Input:
+        - double gram[][]: kxk triangular matrix, with shift added positive definite.
+        - double shift: Added to gram's diagonal.
+        - double rhs[]: b, k entries, not modified.
+        - double x[]: Filled with the solution, k entries.
+        - int k: Number of unknowns.
+        - double scratch[]: At least k * k + 2 * k entries.
+        - int sets[]: At least 2 * k entries, flags of the entries guessed positive followed by their indices.
+    */
+    int i, j, m, iteration, violations, fewest_violations = k + 1, backup = nnls_backup_exchanges, last;
+    double *gradient = scratch, *solved = scratch + k, *factor = scratch + 2 * k;
+    int *passive = sets, *indices = sets + k;
+    for (i = 0; i < k; i++) {
+        passive[i] = 0;
+        x[i] = 0.0;
+        gradient[i] = -rhs[i];
+    }
+    for (iteration = 0; iteration < nnls_max_iter; iteration++) {
+        violations = 0;
+        last = -1;
+        for (i = 0; i < k; i++) {
+            if ((passive[i] && x[i] < 0.0) || (!passive[i] && gradient[i] < 0.0)) {
+                violations++;
+                last = i;
+            }
+        }
+        if (violations == 0) {
+            return 0;
+        }
+        if (violations < fewest_violations || backup > 0) {
+            if (violations < fewest_violations) {
+                fewest_violations = violations;
+                backup = nnls_backup_exchanges;
+            }
+            else {
+                backup--;
+            }
+            for (i = 0; i < k; i++) {
+                if ((passive[i] && x[i] < 0.0) || (!passive[i] && gradient[i] < 0.0)) {
+                    passive[i] = !passive[i];
+                }
+            }
+        }
+        else {
+            passive[last] = !passive[last];
+        }
+        m = 0;
+        for (i = 0; i < k; i++) {
+            if (passive[i]) {
+                indices[m] = i;
+                solved[m++] = rhs[i];
+            }
+        }
+        if (cholesky_subset_solve(gram, shift, indices, m, solved, factor) != 0) {
+            return -1;
+        }
+        for (i = 0; i < k; i++) {
+            x[i] = 0.0;
+        }
+        for (j = 0; j < m; j++) {
+            x[indices[j]] = solved[j];
+        }
+        for (i = 0; i < k; i++) {
+            if (passive[i]) {
+                gradient[i] = 0.0;
+                continue;
+            }
+            gradient[i] = shift * x[i] - rhs[i];
+            for (j = 0; j < m; j++) {
+                gradient[i] += symmetric_entry(gram, i, indices[j]) * x[indices[j]];
+            }
+        }
+    }
+    return -1;
+}
+
+
+void nnls_coordinate_sweep(double **gram, double shift, double *rhs, double *x, int k) {
+    /* Runs one sweep of projected coordinate descent on min_{x >= 0} x^T * C * x - 2 * b^T * x, C = gram + shift * I, minimizing exactly
+       over each entry of x in turn with the others fixed. Entries whose diagonal of C is not positive are left unchanged.
+    Input:
+        - double gram[][]: kxk triangular matrix.
+        - double shift: Added to gram's diagonal.
+        - double rhs[]: b, k entries.
+        - double x[]: Starting point, updated in place.
+        - int k: Number of unknowns.
+    */
+    int i, j;
+    double diagonal, gradient;
+    for (j = 0; j < k; j++) {
+        diagonal = gram[j][j] + shift;
+        if (diagonal <= 0.0) {
+            continue;
+        }
+        gradient = shift * x[j] - rhs[j];
+        for (i = 0; i < k; i++) {
+            gradient += symmetric_entry(gram, j, i) * x[i];
+        }
+        x[j] -= gradient / diagonal;
+        if (x[j] < 0.0) {
+            x[j] = 0.0;
+        }
+    }
+}
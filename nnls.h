@@ -0,0 +1,5 @@
+int cholesky_subset_solve(double **gram, double shift, int *indices, int m, double *rhs, double *factor);
+
+int nnls_block_pivoting(double **gram, double shift, double *rhs, double *x, int k, double *scratch, int *sets);
+
+void nnls_coordinate_sweep(double **gram, double shift, double *rhs, double *x, int k);
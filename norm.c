@@ -1,81 +1,61 @@
 #include <math.h>
 #include <stdlib.h>
 #include "utils.h"
+#include "sym.h"
+#include "parallel.h"
 
-double **diagonal_matrix_multiplication(double **matrix, double **diagonal_matrix, int num_points, int multiplication_direction) {
-    /* Helper function for norm to calculate result of multiplying matrix by a diagonal matrix, supports both left and right multiplication. Does not modify data passed in. Returns NULL on error.
-    Input:
-        - double matrix[][]: Square matrix we are multiplying diagonal matrix by.
-        - double diagonal_matrix[][]: Square diagonal matrix.
-        - int num_points: Dimension of the square matrices (they must have the same dimensions).
-        - int multiplication_direction: If 0, multiplies the diagonal matrix from the left (D * M), if 1 multiplies the diagonal matrix from the right(M * D).
-    Returns:
-        mxn result of the multiplication
-    */
-    int i, j;
-    double **result_matrix = continuous_matrix_creation(num_points, num_points);
-    if (result_matrix == NULL) {
-        return NULL;
-    }
-    for (i = 0; i < num_points; i++) {
-        for (j = 0; j < num_points; j++) {
-            result_matrix[i][j] = matrix[i][j] * diagonal_matrix[multiplication_direction ? j : i][multiplication_direction ? j : i];
-        }
-    }
-    return result_matrix;
-}
-
-
-double **diagonal_matrix_exponentiation(double **diagonal_matrix, int matrix_dimension) {
-    /* Helper function for norm to calculate result of calculating exponent of diagonal matrix. Modifies Input.
+double *diagonal_vector_exponentiation(double *diagonal, int matrix_dimension) {
+    /* Helper function for norm to calculate D^(-1/2) for a diagonal matrix D given by its diagonal alone. Modifies Input.
     Input: 
-        - double diagonal matrix[][] D: Square matrix where each entry other than diagonal is zero, diagonal is free to be any value.
+        - double diagonal[]: Diagonal of a square diagonal matrix D, diagonal is free to be any value.
         - int matrix_dimension: Size of the square diagonal matrix D.
     Returns:
-        2D Matrix D^(-1/2)
+        Diagonal of D^(-1/2)
     */
-   int i;
-   for (i = 0; i < matrix_dimension; i++) {
-        if (diagonal_matrix[i][i] >= 1e-20) {
-            diagonal_matrix[i][i] = 1/(sqrt(diagonal_matrix[i][i]));
+    int i;
+    for (i = 0; i < matrix_dimension; i++) {
+        if (diagonal[i] >= 1e-20) {
+            diagonal[i] = 1/(sqrt(diagonal[i]));
         }
         else {
-            diagonal_matrix[i][i] = 1/(sqrt(diagonal_matrix[i][i]) + 1e-6);
+            diagonal[i] = 1/(sqrt(diagonal[i]) + 1e-6);
         }
-   }
-   return diagonal_matrix;
+    }
+    return diagonal;
 }
 
-double **norm_matrix(double **similarity_matrix, double **diagonal_matrix, int num_points) {
-    /* Creates norm matrix as per project instructions. Returns NULL on error.
+
+/* The norm matrix in double precision, and in single precision with an _f32 suffix */
+#define real double
+#define precision_function(name) name
+#include "norm_template.c"
+#define real float
+#define precision_function(name) name ## _f32
+#include "norm_template.c"
+
+
+float **fused_norm_matrix_mixed(double **datapoints, int num_points, int point_dimension, int exact_exp) {
+    /* Creates the double precision norm matrix rounded to float straight from the datapoints, for mixed precision solves. The similarity
+       matrix is calculated twice without being stored, once for the degrees and once scaled into W and rounded (see
+       similarity_matrix_stream), so the only nxn storage ever allocated is the float triangular matrix that is returned. Returns NULL on error.
     Input: 
-        - double Similarity Matrix[][]: Matrix where each entry corresponds to similarity between points as described in PDF.
-        - double Diagonal Matrix[][]: Matrix where each entry other than diagonal is zero, i'th diagonal entry is sum of the i'th row in the similarity matrix.
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points in Datapoints, this is also the size of the norm matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
     Returns:
-        2D Norm Matrix W: W = D^(-1/2) * A * D^(-1/2)
+        2D Norm Matrix W as a single precision triangular matrix
     */
-    double **norm_matrix;
-    double **diag_exponentiated;
-    double **temp_result;
-    diag_exponentiated = matrix_deep_copy(diagonal_matrix, num_points, num_points);
-    if (diag_exponentiated == NULL) {
-        return NULL;
-    }
-    diag_exponentiated = diagonal_matrix_exponentiation(diag_exponentiated, num_points);
-    if (diag_exponentiated == NULL) {
-        return NULL;
-    }
-    temp_result = diagonal_matrix_multiplication(similarity_matrix, diag_exponentiated, num_points, 0); /* Left Multiplication: D^(-1/2) * A  */
-    if (temp_result == NULL) {
-        free_continuous_matrix(diag_exponentiated);
-        return NULL;
-    }
-    norm_matrix = diagonal_matrix_multiplication(temp_result, diag_exponentiated, num_points, 1); /* Right Multiplication by prev result: (D^(-1/2) * A) * D^(-1/2) */
-    free_continuous_matrix(diag_exponentiated);
-    free_continuous_matrix(temp_result);
-    if (norm_matrix == NULL) {
+    float **normal_matrix = triangular_matrix_creation_f32(num_points);
+    double *degrees = calloc(num_points, sizeof(double));
+    if (normal_matrix == NULL || degrees == NULL ||
+        similarity_matrix_stream(datapoints, num_points, point_dimension, degrees, NULL, NULL, exact_exp) != 0 ||
+        similarity_matrix_stream(datapoints, num_points, point_dimension, NULL, normal_matrix,
+                                     diagonal_vector_exponentiation(degrees, num_points), exact_exp) != 0) {
+        free_continuous_matrix_f32(normal_matrix);
+        free(degrees);
         return NULL;
     }
-
-    return norm_matrix;
-}
\ No newline at end of file
+    free(degrees);
+    return normal_matrix;
+}
@@ -1,7 +1,11 @@
+double *diagonal_vector_exponentiation(double *diagonal, int matrix_dimension);
 
+double **norm_matrix(double **similarity_matrix, double *degrees, int num_points);
 
-double **diagonal_matrix_multiplication(double **matrix, double **diagonal_matrix, int num_points, int multiplication_direction);
+double **fused_norm_matrix(double **datapoints, int num_points, int point_dimension, int exact_exp);
 
-double **diagonal_matrix_exponentiation(double **diagonal_matrix, int matrix_dimension);
+float **norm_matrix_f32(float **similarity_matrix, double *degrees, int num_points);
 
-double **norm_matrix(double **similarity_matrix, double **diagonal_matrix, int num_points);
\ No newline at end of file
+float **fused_norm_matrix_f32(double **datapoints, int num_points, int point_dimension, int exact_exp);
+
+float **fused_norm_matrix_mixed(double **datapoints, int num_points, int point_dimension, int exact_exp);
@@ -0,0 +1,56 @@
+/* Type generic source of norm.c's norm matrix, included once per precision. The includer defines real (the element type of the
+   similarity and norm matrices, degrees are always double) and precision_function(name) (the name of a function's instantiation),
+   both are undefined again at the end. */
+
+
+real **precision_function(norm_matrix)(real **similarity_matrix, double *degrees, int num_points) {
+    /* Turns the similarity matrix into the norm matrix as per project instructions, W = D^(-1/2) * A * D^(-1/2) scales entry (i, j) of A by
+       d_i^(-1/2) * d_j^(-1/2), so it is done in place in a single pass over the upper triangle, rows split between threads. Modifies Input, both the similarity matrix
+       (which becomes W) and degrees (which becomes the diagonal of D^(-1/2)).
+    Input: 
+        - real Similarity Matrix[][]: Triangular matrix where each entry corresponds to similarity between points as described in PDF.
+        - double degrees[]: Diagonal of the diagonal matrix, i'th entry is sum of the i'th row in the similarity matrix.
+        - int num_points: Size of the matrices.
+    Returns:
+        2D Norm Matrix W as a triangular matrix, the same pointer as the similarity matrix
+    */
+    int i, j;
+    diagonal_vector_exponentiation(degrees, num_points);
+#ifdef _OPENMP
+    #pragma omp parallel for private(j) schedule(dynamic, 16) num_threads(num_threads())
+#endif
+    for (i = 0; i < num_points; i++) {
+        for (j = i; j < num_points; j++) {
+            similarity_matrix[i][j] = degrees[i] * similarity_matrix[i][j] * degrees[j];
+        }
+    }
+    return similarity_matrix;
+}
+
+
+real **precision_function(fused_norm_matrix)(double **datapoints, int num_points, int point_dimension, int exact_exp) {
+    /* Creates norm matrix straight from the datapoints. Row sums are accumulated while the similarity matrix is built and kept as a vector,
+       which is then scaled into W in place, so the only nxn storage ever allocated is the triangular matrix that is returned. Returns NULL on error.
+    Input: 
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points in Datapoints, this is also the size of the norm matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    Returns:
+        2D Norm Matrix W as a triangular matrix
+    */
+    real **normal_matrix;
+    double *degrees = calloc(num_points, sizeof(double));
+    if (degrees == NULL) {
+        return NULL;
+    }
+    normal_matrix = precision_function(similarity_matrix_with_degrees)(datapoints, num_points, point_dimension, degrees, exact_exp);
+    if (normal_matrix != NULL) {
+        precision_function(norm_matrix)(normal_matrix, degrees, num_points);
+    }
+    free(degrees);
+    return normal_matrix;
+}
+
+#undef real
+#undef precision_function
@@ -0,0 +1,294 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "utils.h"
+#include "sym.h"
+#include "norm.h"
+#include "mt19937.h"
+#include "gemm.h"
+#include "writer.h"
+#include "nystrom.h"
+#define cholesky_tolerance 1e-10
+
+
+void free_low_rank_matrix(low_rank_matrix *matrix) {
+    /* Frees up low rank matrix memory.
+    Input:
+        - low_rank_matrix *matrix: Matrix whose memory we are freeing, can be NULL.
+    */
+    if (matrix == NULL) return;
+    free_continuous_matrix(matrix->factor);
+    free(matrix->diagonal_shift);
+    free(matrix);
+}
+
+
+int *sample_landmarks(int num_points, int landmarks, unsigned long seed) {
+    /* Samples distinct landmark points uniformly at random (partial Fisher-Yates shuffle). Returns NULL on error.
+    Input:
+        - int num_points: Number of points landmarks are sampled from.
+        - int landmarks: Number of landmarks sampled, at most num_points.
+        - unsigned long seed: Seed of the random generator.
+    Returns:
+        Array of num_points point indices, the first landmarks of which are the sampled landmarks.
+    */
+    int i, j, temp;
+    mt19937_state state;
+    int *indices = malloc(num_points * sizeof(int));
+    if (indices == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < num_points; i++) {
+        indices[i] = i;
+    }
+    mt19937_seed(&state, seed);
+    for (i = 0; i < landmarks; i++) {
+        j = i + (int)(mt19937_uniform(&state) * (num_points - i));
+        temp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = temp;
+    }
+    return indices;
+}
+
+
+int pivoted_cholesky(double **matrix, double **lower, int *order, int m, double tolerance) {
+    /* Calculates a pivoted Cholesky factorization of a positive semi definite matrix, always eliminating the row with the largest remaining
+       diagonal and stopping once every remaining diagonal is below tolerance (relative to the largest diagonal). Returns -1 on error.
+    Input:
+        - double matrix[][]: mxm positive semi definite matrix M, not modified.
+        - double lower[][]: mxm zero instantiated matrix, row/column r of it ends up holding the factor's row/column for pivot order[r].
+        - int order[]: Filled with the elimination order of M's rows.
+        - int m: Size of M.
+        - double tolerance: Relative size below which a remaining diagonal is considered zero.
+    Returns:
+        Rank r of the factorization, M restricted to rows/columns order[0..r) equals L * L^T with L = lower[0..r)[0..r), which is lower triangular.
+    */
+    int r, i, c, pivot, temp;
+    double value, largest = 0.0;
+    double *residual = malloc(m * sizeof(double));
+    if (residual == NULL) {
+        return -1;
+    }
+    for (i = 0; i < m; i++) {
+        residual[i] = matrix[i][i];
+        order[i] = i;
+        if (residual[i] > largest) largest = residual[i];
+    }
+    for (r = 0; r < m; r++) {
+        pivot = r;
+        for (i = r + 1; i < m; i++) {
+            if (residual[order[i]] > residual[order[pivot]]) pivot = i;
+        }
+        if (residual[order[pivot]] <= tolerance * largest) {
+            break;
+        }
+        temp = order[r];
+        order[r] = order[pivot];
+        order[pivot] = temp;
+        for (c = 0; c < r; c++) {
+            value = lower[r][c];
+            lower[r][c] = lower[pivot][c];
+            lower[pivot][c] = value;
+        }
+        lower[r][r] = sqrt(residual[order[r]]);
+        for (i = r + 1; i < m; i++) {
+            value = matrix[order[i]][order[r]];
+            for (c = 0; c < r; c++) {
+                value -= lower[i][c] * lower[r][c];
+            }
+            lower[i][r] = value / lower[r][r];
+            residual[order[i]] -= lower[i][r] * lower[i][r];
+        }
+    }
+    free(residual);
+    return r;
+}
+
+
+low_rank_matrix *nystrom_similarity_matrix(double **datapoints, int num_points, int point_dimension, int landmarks, unsigned long seed) {
+    /* Creates a Nystrom approximation of the similarity matrix without materializing it. With K the gaussian kernel matrix (the similarity
+       matrix with ones on its diagonal), C its columns at a sample of landmarks and M its landmark block, K ~ C * M^-1 * C^T = G * G^T where
+       G = C * L^-T and M = L * L^T. The similarity matrix is then approximated by G * G^T with its diagonal removed, so that like A its diagonal
+       is exactly zero. Landmarks that are numerically redundant (close to others) are dropped by the pivoted Cholesky factorization.
+       Returns NULL on error.
+    Input:
+        - double datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points, this is also the size of the similarity matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - int landmarks: Number of landmarks sampled.
+        - unsigned long seed: Seed of the landmark sampling.
+    Returns:
+        Low rank similarity matrix, factor holds G and diagonal shift i holds ||g_i||^2.
+    */
+    int i, a, b, c, rank;
+    int *landmark_ids, *order;
+    double value;
+    double **kernel, **lower;
+    low_rank_matrix *sym_matrix;
+
+    if (landmarks <= 0) {
+        return NULL;
+    }
+    if (landmarks > num_points) {
+        landmarks = num_points;
+    }
+    landmark_ids = sample_landmarks(num_points, landmarks, seed);
+    order = malloc(landmarks * sizeof(int));
+    kernel = continuous_matrix_creation(landmarks, landmarks);
+    lower = continuous_matrix_creation(landmarks, landmarks);
+    sym_matrix = malloc(sizeof(low_rank_matrix));
+    if (landmark_ids == NULL || order == NULL || kernel == NULL || lower == NULL || sym_matrix == NULL) {
+        free(landmark_ids);
+        free(order);
+        free_continuous_matrix(kernel);
+        free_continuous_matrix(lower);
+        free(sym_matrix);
+        return NULL;
+    }
+    for (a = 0; a < landmarks; a++) {
+        kernel[a][a] = 1.0;
+        for (b = a + 1; b < landmarks; b++) {
+            kernel[a][b] = exp(-(euclidean_distance_squared(datapoints[landmark_ids[a]], datapoints[landmark_ids[b]], point_dimension) / 2.0));
+            kernel[b][a] = kernel[a][b];
+        }
+    }
+    rank = pivoted_cholesky(kernel, lower, order, landmarks, cholesky_tolerance);
+    free_continuous_matrix(kernel);
+    sym_matrix->n = num_points;
+    sym_matrix->rank = rank;
+    sym_matrix->factor = (rank > 0) ? continuous_matrix_creation(num_points, rank) : NULL;
+    sym_matrix->diagonal_shift = malloc(num_points * sizeof(double));
+    if (rank <= 0 || sym_matrix->factor == NULL || sym_matrix->diagonal_shift == NULL) {
+        free(landmark_ids);
+        free(order);
+        free_continuous_matrix(lower);
+        free_low_rank_matrix(sym_matrix);
+        return NULL;
+    }
+    for (i = 0; i < num_points; i++) {
+        sym_matrix->diagonal_shift[i] = 0.0;
+        for (c = 0; c < rank; c++) {
+            /* Forward substitution of L * g_i = c_i, the kernel row of point i against the kept landmarks */
+            value = exp(-(euclidean_distance_squared(datapoints[i], datapoints[landmark_ids[order[c]]], point_dimension) / 2.0));
+            for (b = 0; b < c; b++) {
+                value -= lower[c][b] * sym_matrix->factor[i][b];
+            }
+            sym_matrix->factor[i][c] = value / lower[c][c];
+            sym_matrix->diagonal_shift[i] += sym_matrix->factor[i][c] * sym_matrix->factor[i][c];
+        }
+    }
+    free(landmark_ids);
+    free(order);
+    free_continuous_matrix(lower);
+    return sym_matrix;
+}
+
+
+double *low_rank_diagonal(low_rank_matrix *similarity_matrix) {
+    /* Calculates the diagonal of the diagonal matrix of a low rank similarity matrix, row sums are (G * G^T - S) * 1 = G * (G^T * 1) - S * 1.
+       Approximate row sums can come out slightly negative, these are set to zero. Returns NULL on error.
+    Input:
+        - low_rank_matrix *similarity_matrix: Low rank similarity matrix.
+    Returns:
+        Array whose i'th entry is the sum of row i in the similarity matrix.
+    */
+    int i, c;
+    int n = similarity_matrix->n, rank = similarity_matrix->rank;
+    double *degrees = calloc(n, sizeof(double));
+    double *column_sums = calloc(rank, sizeof(double));
+    if (degrees == NULL || column_sums == NULL) {
+        free(degrees);
+        free(column_sums);
+        return NULL;
+    }
+    for (i = 0; i < n; i++) {
+        for (c = 0; c < rank; c++) {
+            column_sums[c] += similarity_matrix->factor[i][c];
+        }
+    }
+    for (i = 0; i < n; i++) {
+        for (c = 0; c < rank; c++) {
+            degrees[i] += similarity_matrix->factor[i][c] * column_sums[c];
+        }
+        degrees[i] -= similarity_matrix->diagonal_shift[i];
+        if (degrees[i] < 0.0) {
+            degrees[i] = 0.0;
+        }
+    }
+    free(column_sums);
+    return degrees;
+}
+
+
+low_rank_matrix *low_rank_norm_matrix(low_rank_matrix *similarity_matrix, double *degrees) {
+    /* Turns a low rank similarity matrix into the norm matrix W = D^(-1/2) * A * D^(-1/2) = (D^(-1/2) * G) * (D^(-1/2) * G)^T - D^(-1/2) * S * D^(-1/2).
+       Modifies Input, both the matrix (which becomes W) and degrees (which becomes the diagonal of D^(-1/2)).
+    Input:
+        - low_rank_matrix *similarity_matrix: Low rank similarity matrix A.
+        - double degrees[]: Diagonal of the diagonal matrix D.
+    Returns:
+        The given matrix, now holding W.
+    */
+    int i, c;
+    diagonal_vector_exponentiation(degrees, similarity_matrix->n);
+    for (i = 0; i < similarity_matrix->n; i++) {
+        for (c = 0; c < similarity_matrix->rank; c++) {
+            similarity_matrix->factor[i][c] *= degrees[i];
+        }
+        similarity_matrix->diagonal_shift[i] *= degrees[i] * degrees[i];
+    }
+    return similarity_matrix;
+}
+
+
+void low_rank_matrix_multiplication(low_rank_matrix *low_rank, double **matrix, double **projection, double **result_matrix, double *gemm_scratch, int k) {
+    /* Multiplies a low rank nxn matrix G * G^T - S by a regular nxk matrix H as G * (G^T * H) - S * H, in O(n * rank * k).
+       Both products go through gemm, G^T is taken by packing G transposed rather than forming it.
+    Input:
+        - low_rank_matrix *low_rank: Left low rank matrix.
+        - double matrix[][]: Right matrix.
+        - double projection[][]: rankxk scratch matrix G^T * H is formed in.
+        - double result_matrix[][]: nxk matrix the result of multiplying the matrices is written to, its previous contents are overwritten.
+        - double gemm_scratch[]: gemm_scratch_size values of scratch for the products.
+        - int k: Number of columns in right matrix.
+    */
+    int i, c, j;
+    for (c = 0; c < low_rank->rank; c++) {
+        for (j = 0; j < k; j++) {
+            projection[c][j] = 0.0;
+        }
+    }
+    gemm(low_rank->factor, 0, 0, 1, matrix, 0, projection, 0, low_rank->rank, low_rank->n, k, gemm_scratch);
+    for (i = 0; i < low_rank->n; i++) {
+        for (j = 0; j < k; j++) {
+            result_matrix[i][j] = -low_rank->diagonal_shift[i] * matrix[i][j];
+        }
+    }
+    gemm(low_rank->factor, 0, 0, 0, projection, 0, result_matrix, 0, low_rank->n, low_rank->rank, k, gemm_scratch);
+}
+
+
+int print_low_rank_matrix(low_rank_matrix *low_rank) {
+    /* Prints the full matrix G * G^T - S represented by a low rank matrix as per project specifications, or writes it as a binary dataset
+       (see set_binary_output). Returns -1 on error, 0 otherwise.
+    Input:
+        - low_rank_matrix *low_rank: The matrix to be printed
+    */
+    int i, j, c;
+    double entry;
+    matrix_writer writer;
+    if (matrix_writer_open(&writer, low_rank->n, low_rank->n) != 0) {
+        return -1;
+    }
+    for (i = 0; i < low_rank->n; i++) {
+        for (j = 0; j < low_rank->n; j++) {
+            entry = (i == j) ? -low_rank->diagonal_shift[i] : 0.0;
+            for (c = 0; c < low_rank->rank; c++) {
+                entry += low_rank->factor[i][c] * low_rank->factor[j][c];
+            }
+            matrix_writer_value(&writer, entry);
+        }
+    }
+    return matrix_writer_close(&writer);
+}
@@ -0,0 +1,22 @@
+typedef struct low_rank_matrix {
+    double **factor;
+    double *diagonal_shift;
+    int n;
+    int rank;
+} low_rank_matrix;
+
+void free_low_rank_matrix(low_rank_matrix *matrix);
+
+int *sample_landmarks(int num_points, int landmarks, unsigned long seed);
+
+int pivoted_cholesky(double **matrix, double **lower, int *order, int m, double tolerance);
+
+low_rank_matrix *nystrom_similarity_matrix(double **datapoints, int num_points, int point_dimension, int landmarks, unsigned long seed);
+
+double *low_rank_diagonal(low_rank_matrix *similarity_matrix);
+
+low_rank_matrix *low_rank_norm_matrix(low_rank_matrix *similarity_matrix, double *degrees);
+
+void low_rank_matrix_multiplication(low_rank_matrix *low_rank, double **matrix, double **projection, double **result_matrix, double *gemm_scratch, int k);
+
+int print_low_rank_matrix(low_rank_matrix *low_rank);
@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "parallel.h"
+
+/* Thread count of every parallel kernel, 0 until set. omp_set_num_threads only changes the calling thread's setting, so the count is kept
+   here and each parallel region asks for it through a num_threads clause, which makes it hold for kernels started from any thread */
+static int thread_count = 0;
+
+void set_num_threads(int threads) {
+    /* Sets the number of threads every parallel kernel started from now on uses, whichever thread starts it. Kernels already running keep
+       their count. Has no effect when built without OpenMP.
+    Input:
+        - int threads: Number of threads, values below 1 are ignored.
+    */
+    if (threads < 1) return;
+#ifdef _OPENMP
+    #pragma omp atomic write
+    thread_count = threads;
+#endif
+}
+
+
+int num_threads(void) {
+    /* Returns the number of threads a parallel kernel started now would use, the count given to set_num_threads or OpenMP's own default
+       (OMP_NUM_THREADS, or one thread per core) when it was never called. Returns 1 inside an active parallel region, whose nested
+       regions OpenMP runs on a single thread, and when built without OpenMP.
+    */
+#ifdef _OPENMP
+    int threads;
+    if (omp_in_parallel()) {
+        return 1;
+    }
+    #pragma omp atomic read
+    threads = thread_count;
+    return (threads > 0) ? threads : omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+int thread_number(void) {
+    /* Returns the index of the calling thread within the current parallel region, 0 outside of one. */
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+
+double wall_time(void) {
+    /* Returns the current time in seconds from an arbitrary starting point, only differences between calls are meaningful. Without
+       OpenMP this falls back to processor time, which is the same thing for a single threaded process. */
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+
+void num_threads_from_environment(void) {
+    /* Applies the SYMNMF_NUM_THREADS environment variable through set_num_threads if it is set to a positive number, otherwise OpenMP's
+       own defaults (OMP_NUM_THREADS, or one thread per core) stay in effect. */
+    char *value = getenv(num_threads_variable);
+    if (value != NULL) {
+        set_num_threads(atoi(value));
+    }
+}
@@ -0,0 +1,11 @@
+#define num_threads_variable "SYMNMF_NUM_THREADS"
+
+void set_num_threads(int threads);
+
+int num_threads(void);
+
+int thread_number(void);
+
+double wall_time(void);
+
+void num_threads_from_environment(void);
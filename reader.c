@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "reader.h"
+
+static const double powers_of_ten[reader_fast_exponent + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+double parse_double(const char *text, char **end) {
+    /* Converts a decimal number to double, giving exactly the same result as strtod. Numbers of at most 15 significant digits with a
+       power of ten of magnitude at most 22 (practically every number a dataset holds) take Clinger's fast path: the digits and the power of
+       ten are both exact doubles, so a single multiplication or division rounds correctly. Anything else (more digits, larger exponents,
+       inf, nan, hexadecimal) goes to strtod.
+    Input:
+        - const char text[]: Text starting with the number, leading blanks are skipped.
+        - char **end: Set to the first character after the number, to text if there is none.
+    Returns:
+        The number, 0.0 if there is none.
+    */
+    const char *current = text;
+    double mantissa = 0.0, value;
+    int negative = 0, digits = 0, significant = 0, exponent = 0, written_exponent = 0, exponent_negative = 0;
+    while (*current == ' ' || *current == '\t') current++;
+    if (*current == '-' || *current == '+') {
+        negative = (*current == '-');
+        current++;
+    }
+    for (; *current >= '0' && *current <= '9'; current++, digits++) {
+        if (mantissa != 0.0 || *current != '0') significant++;
+        mantissa = mantissa * 10.0 + (*current - '0');
+    }
+    if (*current == '.') {
+        for (current++; *current >= '0' && *current <= '9'; current++, digits++) {
+            if (mantissa != 0.0 || *current != '0') significant++;
+            mantissa = mantissa * 10.0 + (*current - '0');
+            exponent--;
+        }
+    }
+    if (digits > 0 && (*current == 'e' || *current == 'E')) {
+        if (current[1] >= '0' && current[1] <= '9') {
+            current++;
+        }
+        else if ((current[1] == '-' || current[1] == '+') && current[2] >= '0' && current[2] <= '9') {
+            exponent_negative = (current[1] == '-');
+            current += 2;
+        }
+        for (; *current >= '0' && *current <= '9'; current++) {
+            if (written_exponent < 10000) written_exponent = written_exponent * 10 + (*current - '0');
+        }
+        exponent += exponent_negative ? -written_exponent : written_exponent;
+    }
+    if (digits == 0 || *current == 'x' || *current == 'X' || significant > reader_fast_digits || exponent > reader_fast_exponent || exponent < -reader_fast_exponent) {
+        return strtod(text, end);
+    }
+    value = (exponent < 0) ? mantissa / powers_of_ten[-exponent] : mantissa * powers_of_ten[exponent];
+    *end = (char *)current;
+    return negative ? -value : value;
+}
+
+
+int parse_datapoint_line(char *line, double **values, size_t *count, size_t *capacity, int dimension) {
+    /* Parses one line of comma separated numbers, appending them to a growable array. Blanks around numbers (and a trailing carriage
+       return) are allowed, anything else that isn't a number is an error. Returns the number of fields, 0 for a blank line and -1 on error
+       (malformed number, more fields than dimension or failed allocation).
+    Input:
+        - char line[]: Null terminated line, without its newline.
+        - double *values[]: Growable array the fields are appended to, reallocated as needed.
+        - size_t *count: Number of entries in values, updated.
+        - size_t *capacity: Allocated entries in values, updated.
+        - int dimension: Largest allowed number of fields, 0 for no limit.
+    */
+    int fields = 0;
+    char *current = line, *end;
+    double value, *grown;
+    while (*current == ' ' || *current == '\t' || *current == '\r') current++;
+    if (*current == '\0') {
+        return 0;
+    }
+    for (;;) {
+        value = parse_double(current, &end);
+        if (end == current || (dimension > 0 && fields == dimension)) {
+            return -1;
+        }
+        if (*count == *capacity) {
+            *capacity = (*capacity == 0) ? reader_chunk_size / sizeof(double) : *capacity * 2;
+            grown = realloc(*values, *capacity * sizeof(double));
+            if (grown == NULL) {
+                return -1;
+            }
+            *values = grown;
+        }
+        (*values)[(*count)++] = value;
+        fields++;
+        while (*end == ' ' || *end == '\t' || *end == '\r') end++;
+        if (*end == '\0') {
+            return fields;
+        }
+        if (*end != ',') {
+            return -1;
+        }
+        current = end + 1;
+    }
+}
+
+
+double **read_datapoints(const char *filename, int *num_points, int *dimension) {
+    /* Reads comma separated datapoints, one per line, in a single pass over the file: it is read in large chunks, lines of any length are
+       parsed in place and the numbers are appended to one growable array, which then becomes a continuous matrix. Blank lines are skipped,
+       every other line must hold as many numbers as the first one. Returns NULL on error.
+    Input:
+        - const char *filename: Path of the text file.
+        - int *num_points: Set to the number of datapoints read.
+        - int *dimension: Set to the number of coordinates in each datapoint.
+    Returns:
+        Continuous num_points x dimension matrix of the datapoints (free with free_continuous_matrix).
+    */
+    FILE *file = fopen(filename, "r");
+    char *buffer, *line, *newline, *grown_buffer;
+    double *values = NULL, *shrunk_values, **matrix = NULL;
+    size_t buffer_capacity = reader_chunk_size, length = 0, start, read, count = 0, values_capacity = 0;
+    int rows = 0, fields, at_end = 0, failed = 0, i;
+    *dimension = 0;
+    buffer = malloc(buffer_capacity);
+    if (file == NULL || buffer == NULL) {
+        if (file != NULL) fclose(file);
+        free(buffer);
+        return NULL;
+    }
+    while (!at_end && !failed) {
+        if (length == buffer_capacity - 1) { /* A line longer than the buffer, make room for the rest of it */
+            grown_buffer = realloc(buffer, buffer_capacity * 2);
+            if (grown_buffer == NULL) {
+                failed = 1;
+                break;
+            }
+            buffer = grown_buffer;
+            buffer_capacity *= 2;
+        }
+        read = fread(buffer + length, 1, buffer_capacity - 1 - length, file);
+        length += read;
+        at_end = (read == 0);
+        buffer[length] = '\0';
+        start = 0;
+        while (start < length) {
+            line = buffer + start;
+            newline = memchr(line, '\n', length - start);
+            if (newline == NULL && !at_end) {
+                break; /* The rest of the line is in the next chunk */
+            }
+            if (newline != NULL) {
+                *newline = '\0';
+            }
+            fields = parse_datapoint_line(line, &values, &count, &values_capacity, *dimension);
+            if (fields < 0 || (fields > 0 && *dimension > 0 && fields != *dimension) || (fields > 0 && rows == INT_MAX)) {
+                failed = 1;
+                break;
+            }
+            if (fields > 0) {
+                *dimension = fields;
+                rows++;
+            }
+            start = (newline != NULL) ? (size_t)(newline - buffer) + 1 : length;
+        }
+        memmove(buffer, buffer + start, length - start);
+        length -= start;
+    }
+    failed = failed || ferror(file) || rows == 0;
+    fclose(file);
+    free(buffer);
+    if (!failed) {
+        shrunk_values = realloc(values, count * sizeof(double)); /* Give back what the last doubling didn't use */
+        values = (shrunk_values != NULL) ? shrunk_values : values;
+        matrix = malloc(rows * sizeof(double *));
+    }
+    if (matrix == NULL) {
+        free(values);
+        return NULL;
+    }
+    for (i = 0; i < rows; i++) {
+        matrix[i] = values + (size_t)i * *dimension;
+    }
+    *num_points = rows;
+    return matrix;
+}
@@ -0,0 +1,9 @@
+#define reader_chunk_size (1 << 20)
+#define reader_fast_digits 15
+#define reader_fast_exponent 22
+
+double parse_double(const char *text, char **end);
+
+int parse_datapoint_line(char *line, double **values, size_t *count, size_t *capacity, int dimension);
+
+double **read_datapoints(const char *filename, int *num_points, int *dimension);
@@ -1,8 +1,10 @@
 from setuptools import Extension, setup
 
 module = Extension("symnmf_c", 
-                   sources=['symnmfmodule.c', 'utils.c', 'sym.c', 'diagonal.c', 'norm.c', 'symnmf.c'],
-                   extra_compile_args=['-g'] 
+                   sources=['symnmfmodule.c', 'utils.c', 'sym.c', 'diagonal.c', 'norm.c', 'sparse.c', 'kdtree.c', 'nystrom.c', 'mt19937.c', 'fastexp.c', 'gemm.c', 'parallel.c', 'nnls.c', 'mapped.c', 'dataset.c', 'reader.c', 'writer.c', 'symnmf.c'],
+                   depends=['utils_template.c', 'sym_template.c', 'norm_template.c', 'gemm_template.c', 'symnmf_template.c'],
+                   extra_compile_args=['-g', '-fopenmp'],
+                   extra_link_args=['-fopenmp']
 )
 setup(name='symnmf_c',
      version='1.0',
@@ -0,0 +1,481 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "utils.h"
+#include "sym.h"
+#include "norm.h"
+#include "sparse.h"
+#include "kdtree.h"
+#include "writer.h"
+#include "parallel.h"
+#define kd_tree_max_dimension 16
+
+typedef struct csr_entry {
+    int column;
+    double value;
+} csr_entry;
+
+
+csr_matrix *csr_matrix_creation(int n, int nnz) {
+    /* Creates an empty nxn sparse matrix in compressed sparse row (CSR) form with room for nnz stored entries. Returns NULL on error.
+       The entries of row i are values[row_offsets[i]] ... values[row_offsets[i + 1] - 1], their columns are stored at the same positions in columns.
+    Input:
+        - int n: Number of rows and columns in the matrix.
+        - int nnz: Number of stored entries.
+    Returns:
+        Sparse matrix, all row offsets are zero instantiated by default due to use of calloc.
+    */
+    csr_matrix *matrix = malloc(sizeof(csr_matrix));
+    if (matrix == NULL) {
+        return NULL;
+    }
+    matrix->n = n;
+    matrix->nnz = nnz;
+    matrix->values = malloc((nnz > 0 ? nnz : 1) * sizeof(double));
+    matrix->columns = malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+    matrix->row_offsets = calloc(n + 1, sizeof(int));
+    if (matrix->values == NULL || matrix->columns == NULL || matrix->row_offsets == NULL) {
+        free_csr_matrix(matrix);
+        return NULL;
+    }
+    return matrix;
+}
+
+
+void free_csr_matrix(csr_matrix *matrix) {
+    /* Frees up sparse matrix memory.
+    Input:
+        - csr_matrix *matrix: Matrix whose memory we are freeing, can be NULL.
+    */
+    if (matrix == NULL) return;
+    free(matrix->values);
+    free(matrix->columns);
+    free(matrix->row_offsets);
+    free(matrix);
+}
+
+
+edge_list *edge_list_creation(int capacity) {
+    /* Creates an empty growable list of (row, column, value) triplets used to assemble sparse matrices. Returns NULL on error.
+    Input:
+        - int capacity: Number of edges to make room for up front, the list grows when it is exceeded (up to INT_MAX edges).
+    Returns:
+        Empty edge list.
+    */
+    edge_list *edges = malloc(sizeof(edge_list));
+    if (edges == NULL) {
+        return NULL;
+    }
+    if (capacity < 16) {
+        capacity = 16;
+    }
+    edges->count = 0;
+    edges->capacity = capacity;
+    edges->rows = malloc((size_t)capacity * sizeof(int));
+    edges->columns = malloc((size_t)capacity * sizeof(int));
+    edges->values = malloc((size_t)capacity * sizeof(double));
+    if (edges->rows == NULL || edges->columns == NULL || edges->values == NULL) {
+        free_edge_list(edges);
+        return NULL;
+    }
+    return edges;
+}
+
+
+int edge_list_append(edge_list *edges, int row, int column, double value) {
+    /* Appends an edge to the list, doubling its capacity (capped at INT_MAX) when full. Returns 1 on success and 0 on error,
+       which includes the list already holding INT_MAX edges.
+    Input:
+        - edge_list *edges: List we are appending to.
+        - int row, int column: Position of the entry.
+        - double value: Value of the entry.
+    */
+    int *new_rows, *new_columns;
+    double *new_values;
+    size_t new_capacity;
+    if (edges->count == edges->capacity) {
+        if (edges->capacity == INT_MAX) return 0;
+        new_capacity = (edges->capacity > INT_MAX / 2) ? (size_t)INT_MAX : 2 * (size_t)edges->capacity;
+        new_rows = realloc(edges->rows, new_capacity * sizeof(int));
+        if (new_rows == NULL) return 0;
+        edges->rows = new_rows;
+        new_columns = realloc(edges->columns, new_capacity * sizeof(int));
+        if (new_columns == NULL) return 0;
+        edges->columns = new_columns;
+        new_values = realloc(edges->values, new_capacity * sizeof(double));
+        if (new_values == NULL) return 0;
+        edges->values = new_values;
+        edges->capacity = (int)new_capacity;
+    }
+    edges->rows[edges->count] = row;
+    edges->columns[edges->count] = column;
+    edges->values[edges->count] = value;
+    edges->count++;
+    return 1;
+}
+
+
+void free_edge_list(edge_list *edges) {
+    /* Frees up edge list memory.
+    Input:
+        - edge_list *edges: List whose memory we are freeing, can be NULL.
+    */
+    if (edges == NULL) return;
+    free(edges->rows);
+    free(edges->columns);
+    free(edges->values);
+    free(edges);
+}
+
+
+int csr_entry_compare(const void *entry, const void *other_entry) {
+    /* qsort comparator ordering csr entries by column. */
+    int column = ((const csr_entry *)entry)->column;
+    int other_column = ((const csr_entry *)other_entry)->column;
+    return (column > other_column) - (column < other_column);
+}
+
+
+csr_matrix *csr_from_edge_list(edge_list *edges, int n) {
+    /* Builds a symmetric sparse matrix out of an edge list, every edge (i, j) is stored as both (i, j) and (j, i).
+       Edges listed in both directions (or more than once) are stored once, entries within a row are sorted by column. Returns NULL on error,
+       which includes lists of more than INT_MAX / 2 edges since the stored entries are counted in int.
+    Input:
+        - edge_list *edges: Edges of the matrix, self loops are ignored.
+        - int n: Number of rows and columns in the matrix.
+    Returns:
+        Symmetric sparse matrix.
+    */
+    int i, e, start, end, count, total;
+    int *row_counts;
+    csr_entry *entries;
+    csr_matrix *matrix;
+
+    if (edges->count > INT_MAX / 2) {
+        return NULL;
+    }
+    row_counts = calloc((size_t)n + 1, sizeof(int));
+    entries = malloc((edges->count > 0 ? 2 * (size_t)edges->count : 1) * sizeof(csr_entry));
+    if (row_counts == NULL || entries == NULL) {
+        free(row_counts);
+        free(entries);
+        return NULL;
+    }
+    for (e = 0; e < edges->count; e++) {
+        if (edges->rows[e] != edges->columns[e]) {
+            row_counts[edges->rows[e] + 1]++;
+            row_counts[edges->columns[e] + 1]++;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        row_counts[i + 1] += row_counts[i];
+    }
+    for (e = 0; e < edges->count; e++) {
+        if (edges->rows[e] != edges->columns[e]) {
+            entries[row_counts[edges->rows[e]]].column = edges->columns[e];
+            entries[row_counts[edges->rows[e]]++].value = edges->values[e];
+            entries[row_counts[edges->columns[e]]].column = edges->rows[e];
+            entries[row_counts[edges->columns[e]]++].value = edges->values[e];
+        }
+    }
+    /* row_counts[i] now holds the end of row i, which is the start of row i + 1 */
+    total = 0;
+    start = 0;
+    for (i = 0; i < n; i++) {
+        end = row_counts[i];
+        qsort(entries + start, end - start, sizeof(csr_entry), csr_entry_compare);
+        row_counts[i] = total;
+        for (e = start; e < end; e++) {
+            if (e == start || entries[e].column != entries[e - 1].column) {
+                entries[total++] = entries[e];
+            }
+        }
+        start = end;
+    }
+    row_counts[n] = total;
+
+    matrix = csr_matrix_creation(n, total);
+    if (matrix == NULL) {
+        free(row_counts);
+        free(entries);
+        return NULL;
+    }
+    for (i = 0; i <= n; i++) {
+        matrix->row_offsets[i] = row_counts[i];
+    }
+    for (count = 0; count < total; count++) {
+        matrix->columns[count] = entries[count].column;
+        matrix->values[count] = entries[count].value;
+    }
+    free(row_counts);
+    free(entries);
+    return matrix;
+}
+
+
+void heap_sift_down(double *keys, int *ids, int size, int position) {
+    /* Restores the max-heap property of keys (ids move along with their keys) below the given position. */
+    int largest, child;
+    double key;
+    int id;
+    while (1) {
+        largest = position;
+        child = 2 * position + 1;
+        if (child < size && keys[child] > keys[largest]) largest = child;
+        if (child + 1 < size && keys[child + 1] > keys[largest]) largest = child + 1;
+        if (largest == position) return;
+        key = keys[position]; keys[position] = keys[largest]; keys[largest] = key;
+        id = ids[position]; ids[position] = ids[largest]; ids[largest] = id;
+        position = largest;
+    }
+}
+
+
+void heap_sift_up(double *keys, int *ids, int position) {
+    /* Restores the max-heap property of keys (ids move along with their keys) above the given position. */
+    int parent;
+    double key;
+    int id;
+    while (position > 0) {
+        parent = (position - 1) / 2;
+        if (keys[parent] >= keys[position]) return;
+        key = keys[position]; keys[position] = keys[parent]; keys[parent] = key;
+        id = ids[position]; ids[position] = ids[parent]; ids[parent] = id;
+        position = parent;
+    }
+}
+
+
+int nearest_neighbour_edges(double **datapoints, int num_points, int point_dimension, int neighbours, double threshold, edge_list *edges) {
+    /* Appends an edge from every point to each of its nearest neighbours, found by scanning all other points while keeping the
+       closest ones in a bounded max-heap. Returns 1 on success and 0 on error.
+    Input:
+        - double datapoints[][]: 2D Array of points.
+        - int num_points: Number of points.
+        - int point_dimension: Number of coordinates in each point.
+        - int neighbours: Number of nearest neighbours kept per point.
+        - double threshold: Edges whose similarity is below threshold are dropped, 0 keeps every neighbour.
+        - edge_list *edges: List the edges (with their similarity as value) are appended to.
+    */
+    int i, j, size;
+    double distance_squared, value;
+    double *keys = malloc(neighbours * sizeof(double));
+    int *ids = malloc(neighbours * sizeof(int));
+    if (keys == NULL || ids == NULL) {
+        free(keys);
+        free(ids);
+        return 0;
+    }
+    for (i = 0; i < num_points; i++) {
+        size = 0;
+        for (j = 0; j < num_points; j++) {
+            if (j == i) continue;
+            distance_squared = euclidean_distance_squared(datapoints[i], datapoints[j], point_dimension);
+            if (size < neighbours) {
+                keys[size] = distance_squared;
+                ids[size] = j;
+                heap_sift_up(keys, ids, size++);
+            }
+            else if (distance_squared < keys[0]) {
+                keys[0] = distance_squared;
+                ids[0] = j;
+                heap_sift_down(keys, ids, size, 0);
+            }
+        }
+        for (j = 0; j < size; j++) {
+            value = exp(-(keys[j] / 2.0));
+            if (value >= threshold && !edge_list_append(edges, i, ids[j], value)) {
+                free(keys);
+                free(ids);
+                return 0;
+            }
+        }
+    }
+    free(keys);
+    free(ids);
+    return 1;
+}
+
+
+int threshold_edges(double **datapoints, int num_points, int point_dimension, double threshold, edge_list *edges) {
+    /* Appends an edge for every pair of points i < j whose similarity exp(-||x_i - x_j||^2 / 2) is at least threshold.
+       Returns 1 on success and 0 on error.
+    Input:
+        - double datapoints[][]: 2D Array of points.
+        - int num_points: Number of points.
+        - int point_dimension: Number of coordinates in each point.
+        - double threshold: Smallest similarity that is kept, must be positive.
+        - edge_list *edges: List the edges (with their similarity as value) are appended to.
+    */
+    int i, j;
+    double distance_squared, value;
+    double max_distance_squared = -2.0 * log(threshold);
+    for (i = 0; i < num_points; i++) {
+        for (j = i + 1; j < num_points; j++) {
+            distance_squared = euclidean_distance_squared(datapoints[i], datapoints[j], point_dimension);
+            if (distance_squared <= max_distance_squared) {
+                value = exp(-(distance_squared / 2.0));
+                if (value >= threshold && !edge_list_append(edges, i, j, value)) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+
+csr_matrix *sparse_similarity_matrix(double **datapoints, int num_points, int point_dimension, int neighbours, double threshold) {
+    /* Creates a sparse similarity matrix, keeping only entries of the project's similarity matrix between each point and its k nearest
+       neighbours whose similarity is at least threshold (every pair of points whose similarity is at least threshold when k is 0). The kept graph is
+       symmetrized (an entry is kept if either point keeps the other) so the matrix stays symmetric. Neighbours are found through a KD-tree
+       for low dimensional points and by scanning every pair otherwise. Returns NULL on error, which includes num_points * neighbours above
+       INT_MAX.
+    Input:
+        - double datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points, this is also the size of the similarity matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - int neighbours: Number of nearest neighbours kept per point, 0 to only use the threshold.
+        - double threshold: Smallest similarity that is kept, 0 to only use the neighbours.
+    Returns:
+        Sparse similarity matrix.
+    */
+    edge_list *edges;
+    kd_tree *tree;
+    csr_matrix *sym_matrix;
+    int success;
+    if (neighbours <= 0 && threshold <= 0.0) {
+        return NULL;
+    }
+    if (neighbours >= num_points) {
+        neighbours = num_points - 1;
+    }
+    if (neighbours > 0 && (size_t)num_points * (size_t)neighbours > INT_MAX) {
+        return NULL;
+    }
+    edges = edge_list_creation(neighbours > 0 ? num_points * neighbours : num_points);
+    if (edges == NULL) {
+        return NULL;
+    }
+    if (point_dimension <= kd_tree_max_dimension) {
+        /* In low dimensions a KD-tree prunes most pairs, in higher ones it ends up visiting nearly all of them and the plain scan is cheaper */
+        tree = kd_tree_creation(datapoints, num_points, point_dimension);
+        if (tree == NULL) {
+            free_edge_list(edges);
+            return NULL;
+        }
+        if (neighbours > 0) {
+            success = kd_tree_nearest_neighbour_edges(tree, neighbours, threshold, edges);
+        }
+        else {
+            success = kd_tree_threshold_edges(tree, threshold, edges);
+        }
+        free_kd_tree(tree);
+    }
+    else if (neighbours > 0) {
+        success = nearest_neighbour_edges(datapoints, num_points, point_dimension, neighbours, threshold, edges);
+    }
+    else {
+        success = threshold_edges(datapoints, num_points, point_dimension, threshold, edges);
+    }
+    sym_matrix = success ? csr_from_edge_list(edges, num_points) : NULL;
+    free_edge_list(edges);
+    return sym_matrix;
+}
+
+
+double *sparse_diagonal(csr_matrix *similarity_matrix) {
+    /* Calculates the diagonal of the diagonal matrix of a sparse similarity matrix. Returns NULL on error.
+    Input:
+        - csr_matrix *similarity_matrix: Sparse similarity matrix.
+    Returns:
+        Array whose i'th entry is the sum of row i in the similarity matrix.
+    */
+    int i, e;
+    double *degrees = calloc(similarity_matrix->n, sizeof(double));
+    if (degrees == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < similarity_matrix->n; i++) {
+        for (e = similarity_matrix->row_offsets[i]; e < similarity_matrix->row_offsets[i + 1]; e++) {
+            degrees[i] += similarity_matrix->values[e];
+        }
+    }
+    return degrees;
+}
+
+
+csr_matrix *sparse_norm_matrix(csr_matrix *similarity_matrix, double *degrees) {
+    /* Turns a sparse similarity matrix into the norm matrix W = D^(-1/2) * A * D^(-1/2). Modifies Input, both the matrix
+       (which becomes W) and degrees (which becomes the diagonal of D^(-1/2)).
+    Input:
+        - csr_matrix *similarity_matrix: Sparse similarity matrix A.
+        - double degrees[]: Diagonal of the diagonal matrix D.
+    Returns:
+        The given matrix, now holding W.
+    */
+    int i, e;
+    diagonal_vector_exponentiation(degrees, similarity_matrix->n);
+    for (i = 0; i < similarity_matrix->n; i++) {
+        for (e = similarity_matrix->row_offsets[i]; e < similarity_matrix->row_offsets[i + 1]; e++) {
+            similarity_matrix->values[e] = degrees[i] * similarity_matrix->values[e] * degrees[similarity_matrix->columns[e]];
+        }
+    }
+    return similarity_matrix;
+}
+
+
+void sparse_matrix_multiplication(csr_matrix *sparse_matrix, double **matrix, double **result_matrix, int k) {
+    /* Multiplies a sparse nxn matrix by a regular nxk matrix, every row of the result only depends on its own row so rows are split between threads.
+    Input:
+        - csr_matrix *sparse_matrix: Left sparse matrix.
+        - double matrix[][]: Right matrix.
+        - double result_matrix[][]: nxk matrix the result of multiplying the matrices is written to, its previous contents are overwritten.
+        - int k: Number of columns in right matrix.
+    */
+    int i, e, c;
+    double value;
+    double *row;
+#ifdef _OPENMP
+    #pragma omp parallel for private(e, c, value, row) schedule(dynamic, 64) num_threads(num_threads())
+#endif
+    for (i = 0; i < sparse_matrix->n; i++) {
+        for (c = 0; c < k; c++) {
+            result_matrix[i][c] = 0.0;
+        }
+        for (e = sparse_matrix->row_offsets[i]; e < sparse_matrix->row_offsets[i + 1]; e++) {
+            value = sparse_matrix->values[e];
+            row = matrix[sparse_matrix->columns[e]];
+            for (c = 0; c < k; c++) {
+                result_matrix[i][c] += value * row[c];
+            }
+        }
+    }
+}
+
+
+int print_sparse_matrix(csr_matrix *sparse_matrix) {
+    /* Prints sparse matrix as per project specifications, entries that are not stored are printed as zero, or writes it as a binary dataset
+       (see set_binary_output). Returns -1 on error, 0 otherwise.
+    Input:
+        - csr_matrix *sparse_matrix: The matrix to be printed
+    */
+    int i, j, e;
+    matrix_writer writer;
+    if (matrix_writer_open(&writer, sparse_matrix->n, sparse_matrix->n) != 0) {
+        return -1;
+    }
+    for (i = 0; i < sparse_matrix->n; i++) {
+        e = sparse_matrix->row_offsets[i];
+        for (j = 0; j < sparse_matrix->n; j++) {
+            if (e < sparse_matrix->row_offsets[i + 1] && sparse_matrix->columns[e] == j) {
+                matrix_writer_value(&writer, sparse_matrix->values[e++]);
+            }
+            else {
+                matrix_writer_value(&writer, 0.0);
+            }
+        }
+    }
+    return matrix_writer_close(&writer);
+}
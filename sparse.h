@@ -0,0 +1,47 @@
+typedef struct csr_matrix {
+    double *values;
+    int *columns;
+    int *row_offsets;
+    int n;
+    int nnz;
+} csr_matrix;
+
+typedef struct edge_list {
+    int *rows;
+    int *columns;
+    double *values;
+    int count;
+    int capacity;
+} edge_list;
+
+csr_matrix *csr_matrix_creation(int n, int nnz);
+
+void free_csr_matrix(csr_matrix *matrix);
+
+edge_list *edge_list_creation(int capacity);
+
+int edge_list_append(edge_list *edges, int row, int column, double value);
+
+void free_edge_list(edge_list *edges);
+
+int csr_entry_compare(const void *entry, const void *other_entry);
+
+csr_matrix *csr_from_edge_list(edge_list *edges, int n);
+
+void heap_sift_down(double *keys, int *ids, int size, int position);
+
+void heap_sift_up(double *keys, int *ids, int position);
+
+int nearest_neighbour_edges(double **datapoints, int num_points, int point_dimension, int neighbours, double threshold, edge_list *edges);
+
+int threshold_edges(double **datapoints, int num_points, int point_dimension, double threshold, edge_list *edges);
+
+csr_matrix *sparse_similarity_matrix(double **datapoints, int num_points, int point_dimension, int neighbours, double threshold);
+
+double *sparse_diagonal(csr_matrix *similarity_matrix);
+
+csr_matrix *sparse_norm_matrix(csr_matrix *similarity_matrix, double *degrees);
+
+void sparse_matrix_multiplication(csr_matrix *sparse_matrix, double **matrix, double **result_matrix, int k);
+
+int print_sparse_matrix(csr_matrix *sparse_matrix);
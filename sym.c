@@ -1,6 +1,11 @@
 #include <math.h>
 #include <stdlib.h>
 #include "utils.h"
+#include "fastexp.h"
+#include "parallel.h"
+#include "sym.h"
+#define similarity_block_size 64
+#define dimension_block_size 256
 
 double euclidean_distance_squared(double point[], double other_point[], int point_dimension) {
     /* Calculates squared euclidean distance between two datapoints
@@ -20,36 +25,183 @@ double euclidean_distance_squared(double point[], double other_point[], int poin
 }
 
 
-double **similarity_matrix(double **datapoints, int num_points, int point_dimension) {
-    /* Creates similarity matrix as per project instructions. Returns NULL on error.
-    Input: 
-        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.datapoints
-        - int num_points: Number of points in Datapoints, this is also the size of the similarity matrix as each entry in it corresponds to a point
-        - int point_dimension: Number of coordinates in each point, we pass it in as euclidean_distance_squared has need of it in order to calculate distance between two points.
+double *row_squared_norms(double **datapoints, int num_points, int point_dimension) {
+    /* Calculates the squared euclidean norm of every datapoint, used to turn inner products into distances. Returns NULL on error.
+    Input:
+        - double datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points in datapoints.
+        - int point_dimension: Number of coordinates in each point.
     Returns:
-        2D Similarity Matrix
+        Array whose i'th entry is ||x_i||^2.
     */
-
-    int i;
-    int j;
-    double **sym_matrix;
-    double distance_squared;
-
-    sym_matrix = continuous_matrix_creation(num_points, num_points);
-    if (sym_matrix == NULL) {
+    int i, l;
+    double *norms = malloc(num_points * sizeof(double));
+    if (norms == NULL) {
         return NULL;
     }
     for (i = 0; i < num_points; i++) {
-        for (j = 0; j < num_points; j++) {
-            /* Calloc instantiates all elements to zero, therefore no need to set a_ii = 0 manually */
-            if (i != j) {
-                distance_squared = euclidean_distance_squared(datapoints[i], datapoints[j], point_dimension);
-                sym_matrix[i][j] = exp(-(distance_squared / 2.0));
-            }
+        norms[i] = 0.0;
+        for (l = 0; l < point_dimension; l++) {
+            norms[i] += datapoints[i][l] * datapoints[i][l];
+        }
+    }
+    return norms;
+}
+
 
+void block_inner_products(double **datapoints, double **result_matrix, int row_start, int row_end, int col_start, int col_end, int dim_start, int dim_end) {
+    /* Accumulates the inner products x_i . x_j restricted to coordinates [dim_start, dim_end) into result_matrix[i][j],
+       for every i in [row_start, row_end) and j in [col_start, col_end) with j > i. Four columns are handled at once so every
+       coordinate of x_i that is loaded is reused four times.
+    Input:
+        - double datapoints[][]: 2D Array of points.
+        - double result_matrix[][]: Matrix whose upper triangle accumulates the inner products.
+        - int row_start, row_end: Row tile of the block.
+        - int col_start, col_end: Column tile of the block.
+        - int dim_start, dim_end: Coordinate tile of the block.
+    */
+    int i, j, l, first_col;
+    double *x, *y0, *y1, *y2, *y3;
+    double s0, s1, s2, s3;
+    for (i = row_start; i < row_end; i++) {
+        x = datapoints[i];
+        first_col = (col_start > i) ? col_start : i + 1;
+        for (j = first_col; j + 3 < col_end; j += 4) {
+            y0 = datapoints[j];
+            y1 = datapoints[j + 1];
+            y2 = datapoints[j + 2];
+            y3 = datapoints[j + 3];
+            s0 = s1 = s2 = s3 = 0.0;
+            for (l = dim_start; l < dim_end; l++) {
+                s0 += x[l] * y0[l];
+                s1 += x[l] * y1[l];
+                s2 += x[l] * y2[l];
+                s3 += x[l] * y3[l];
+            }
+            result_matrix[i][j] += s0;
+            result_matrix[i][j + 1] += s1;
+            result_matrix[i][j + 2] += s2;
+            result_matrix[i][j + 3] += s3;
+        }
+        for (; j < col_end; j++) {
+            y0 = datapoints[j];
+            s0 = 0.0;
+            for (l = dim_start; l < dim_end; l++) {
+                s0 += x[l] * y0[l];
+            }
+            result_matrix[i][j] += s0;
         }
     }
-    return sym_matrix;
 }
 
 
+/* The similarity matrix in double precision, and in single precision with an _f32 suffix */
+#define real double
+#define precision_function(name) name
+#define precision_single 0
+#include "sym_template.c"
+#define real float
+#define precision_function(name) name ## _f32
+#define precision_single 1
+#include "sym_template.c"
+
+
+int similarity_matrix_stream(double **datapoints, int num_points, int point_dimension, double *degrees, float **normal_matrix, double *scales, int exact_exp) {
+    /* Runs over the double precision similarity matrix row by row without storing it in double, summing its rows and/or writing it, or
+       the norm matrix it scales into, rounded to float. Rows are produced exactly as in similarity_matrix_fill: row blocks are spread over
+       threads and each thread accumulates a block's tiled inner products, and then its exponentials, in a double scratch block of its own.
+       The diagonal matrix is a single pass for the degrees, so it needs O(n) memory. The single precision similarity matrix is a single
+       pass writing the rounded entries. A mixed precision norm matrix is two passes, one for the degrees and one for W, so it equals the
+       double precision one rounded to float without any double nxn storage. Returns -1 on error, 0 otherwise.
+    Input: 
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.
+        - int num_points: Number of points in Datapoints, this is also the size of the similarity matrix.
+        - int point_dimension: Number of coordinates in each point.
+        - double degrees[]: Zero instantiated array of num_points, entry i ends up holding the sum of row i (of the similarity matrix,
+          whatever is written). Can be NULL if normal_matrix is given.
+        - float normal_matrix[][]: Triangular matrix (see triangular_matrix_creation_f32) the entries (i, j), j > i, are written to, or
+          NULL to only sum the rows into degrees.
+        - double scales[]: Diagonal of D^(-1/2) (see diagonal_vector_exponentiation), entry (i, j) of the norm matrix is
+          scales[i] * A_ij * scales[j], or NULL to write the similarity matrix A itself. Unused if normal_matrix is NULL.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    */
+    int i, j, t, row_block, row_end, col_block, dim_block;
+    int threads = num_threads();
+    double *norms, *partial_degrees = NULL, *scratch, *row_degrees, *exponents;
+    double **scratch_rows, **block_rows;
+    double distance_squared;
+
+    norms = row_squared_norms(datapoints, num_points, point_dimension);
+    scratch = malloc((size_t)threads * similarity_block_size * num_points * sizeof(double));
+    scratch_rows = malloc((size_t)threads * num_points * sizeof(double *)); /* Indexed by row like the matrix, only a block's rows are set */
+    if (degrees != NULL && threads > 1) {
+        partial_degrees = calloc((size_t)threads * num_points, sizeof(double));
+    }
+    if (norms == NULL || scratch == NULL || scratch_rows == NULL || (degrees != NULL && threads > 1 && partial_degrees == NULL)) {
+        free(norms);
+        free(scratch);
+        free(scratch_rows);
+        free(partial_degrees);
+        return -1;
+    }
+#ifdef _OPENMP
+    #pragma omp parallel for private(i, j, row_end, col_block, dim_block, block_rows, row_degrees, exponents, distance_squared) schedule(dynamic) num_threads(threads)
+#endif
+    for (row_block = 0; row_block < num_points; row_block += similarity_block_size) {
+        row_end = (row_block + similarity_block_size < num_points) ? row_block + similarity_block_size : num_points;
+        block_rows = scratch_rows + (size_t)thread_number() * num_points;
+        for (i = row_block; i < row_end; i++) {
+            block_rows[i] = scratch + ((size_t)thread_number() * similarity_block_size + (i - row_block)) * num_points;
+            for (j = i + 1; j < num_points; j++) {
+                block_rows[i][j] = 0.0;
+            }
+        }
+        for (col_block = row_block; col_block < num_points; col_block += similarity_block_size) {
+            for (dim_block = 0; dim_block < point_dimension; dim_block += dimension_block_size) {
+                block_inner_products(datapoints, block_rows, row_block, row_end,
+                                     col_block, (col_block + similarity_block_size < num_points) ? col_block + similarity_block_size : num_points,
+                                     dim_block, (dim_block + dimension_block_size < point_dimension) ? dim_block + dimension_block_size : point_dimension);
+            }
+        }
+        for (i = row_block; i < row_end; i++) {
+            exponents = block_rows[i] + i + 1;
+            for (j = i + 1; j < num_points; j++) {
+                distance_squared = norms[i] + norms[j] - 2.0 * block_rows[i][j];
+                if (distance_squared < 0.0) {
+                    distance_squared = 0.0;
+                }
+                exponents[j - i - 1] = -(distance_squared / 2.0);
+            }
+            exp_batch(exponents, num_points - i - 1, exact_exp);
+            if (normal_matrix != NULL && scales != NULL) {
+                for (j = i + 1; j < num_points; j++) {
+                    normal_matrix[i][j] = (float)(scales[i] * exponents[j - i - 1] * scales[j]);
+                }
+            }
+            else if (normal_matrix != NULL) {
+                for (j = i + 1; j < num_points; j++) {
+                    normal_matrix[i][j] = (float)exponents[j - i - 1];
+                }
+            }
+            if (degrees != NULL) {
+                row_degrees = (partial_degrees != NULL) ? partial_degrees + (size_t)thread_number() * num_points : degrees;
+                for (j = i + 1; j < num_points; j++) {
+                    row_degrees[i] += exponents[j - i - 1];
+                    row_degrees[j] += exponents[j - i - 1];
+                }
+            }
+        }
+    }
+    if (partial_degrees != NULL) {
+        for (t = 0; t < threads; t++) {
+            for (i = 0; i < num_points; i++) {
+                degrees[i] += partial_degrees[(size_t)t * num_points + i];
+            }
+        }
+        free(partial_degrees);
+    }
+    free(norms);
+    free(scratch);
+    free(scratch_rows);
+    return 0;
+}
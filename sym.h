@@ -1,5 +1,19 @@
+double euclidean_distance_squared(double point[], double other_point[], int point_dimension);
 
+double *row_squared_norms(double **datapoints, int num_points, int point_dimension);
 
-double euclidean_distance_squared(double point[], double other_point[], int point_dimension);
+void block_inner_products(double **datapoints, double **result_matrix, int row_start, int row_end, int col_start, int col_end, int dim_start, int dim_end);
+
+int similarity_matrix_fill(double **datapoints, double **sym_matrix, int num_points, int point_dimension, double *degrees, int exact_exp);
+
+double **similarity_matrix(double **datapoints, int num_points, int point_dimension, int exact_exp);
+
+double **similarity_matrix_with_degrees(double **datapoints, int num_points, int point_dimension, double *degrees, int exact_exp);
+
+int similarity_matrix_fill_f32(double **datapoints, float **sym_matrix, int num_points, int point_dimension, double *degrees, int exact_exp);
+
+float **similarity_matrix_f32(double **datapoints, int num_points, int point_dimension, int exact_exp);
+
+float **similarity_matrix_with_degrees_f32(double **datapoints, int num_points, int point_dimension, double *degrees, int exact_exp);
 
-double **similarity_matrix(double **datapoints, int num_points, int point_dimension);
\ No newline at end of file
+int similarity_matrix_stream(double **datapoints, int num_points, int point_dimension, double *degrees, float **normal_matrix, double *scales, int exact_exp);
@@ -0,0 +1,135 @@
+/* Type generic source of sym.c's similarity matrix, included once per precision. The includer defines real (the element type of the
+   similarity matrix, the datapoints are always double), precision_function(name) (the name of a function's instantiation) and
+   precision_single (1 when real is float, 0 otherwise), all of them are undefined again at the end. */
+
+
+#if precision_single
+int precision_function(similarity_matrix_fill)(double **datapoints, real **sym_matrix, int num_points, int point_dimension, double *degrees, int exact_exp) {
+    /* Fills a single precision similarity matrix into given storage, optionally summing its rows, with the same arguments as the double
+       precision similarity_matrix_fill. Its rows are streamed through double scratch (see similarity_matrix_stream), so inner products,
+       distances, exponentials and degrees are all calculated in double precision and only the stored entries are rounded to float.
+       Returns -1 on error, 0 otherwise.
+    */
+    return similarity_matrix_stream(datapoints, num_points, point_dimension, degrees, sym_matrix, NULL, exact_exp);
+}
+#else
+int precision_function(similarity_matrix_fill)(double **datapoints, real **sym_matrix, int num_points, int point_dimension, double *degrees, int exact_exp) {
+    /* Fills a similarity matrix as per project instructions into given storage, optionally summing its rows (the diagonal of the diagonal matrix) as they
+       are produced so that neither a full diagonal matrix nor a second pass over the similarity matrix is needed. Returns -1 on error, 0 otherwise.
+       Distances are obtained from a tiled X * X^T product via ||x||^2 + ||y||^2 - 2 x.y instead of a per pair loop,
+       since the matrix is symmetric only tiles on or above the diagonal are computed and only the upper triangle is stored.
+       Row tiles and rows are spread over threads, each thread sums rows into its own copy of the degrees which are added up at the end.
+    Input: 
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.datapoints
+        - real sym_matrix[][]: Zero instantiated triangular matrix (see triangular_matrix_creation), or any storage with the same row pointers.
+        - int num_points: Number of points in Datapoints, this is also the size of the similarity matrix as each entry in it corresponds to a point
+        - int point_dimension: Number of coordinates in each point.
+        - double degrees[]: Zero instantiated array of num_points, entry i ends up holding the sum of row i. Can be NULL if row sums aren't needed.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    */
+
+    int i, j, t;
+    int row_block, col_block, dim_block;
+    int threads = num_threads();
+    double *norms, *partial_degrees = NULL, *row_degrees, *exponents;
+    double distance_squared;
+
+    norms = row_squared_norms(datapoints, num_points, point_dimension);
+    if (degrees != NULL && threads > 1) {
+        partial_degrees = calloc((size_t)threads * num_points, sizeof(double));
+    }
+    if (norms == NULL || (degrees != NULL && threads > 1 && partial_degrees == NULL)) {
+        free(norms);
+        free(partial_degrees);
+        return -1;
+    }
+#ifdef _OPENMP
+    #pragma omp parallel for private(col_block, dim_block) schedule(dynamic) num_threads(threads)
+#endif
+    for (row_block = 0; row_block < num_points; row_block += similarity_block_size) {
+        for (col_block = row_block; col_block < num_points; col_block += similarity_block_size) {
+            for (dim_block = 0; dim_block < point_dimension; dim_block += dimension_block_size) {
+                block_inner_products(datapoints, sym_matrix, 
+                                     row_block, (row_block + similarity_block_size < num_points) ? row_block + similarity_block_size : num_points,
+                                     col_block, (col_block + similarity_block_size < num_points) ? col_block + similarity_block_size : num_points,
+                                     dim_block, (dim_block + dimension_block_size < point_dimension) ? dim_block + dimension_block_size : point_dimension);
+            }
+        }
+    }
+#ifdef _OPENMP
+    #pragma omp parallel for private(j, distance_squared, row_degrees, exponents) schedule(dynamic, 16) num_threads(threads)
+#endif
+    for (i = 0; i < num_points; i++) {
+        /* Calloc instantiates all elements to zero, therefore no need to set a_ii = 0 manually */
+        exponents = sym_matrix[i] + i + 1; /* The rest of row i is contiguous in the triangular storage and exponentiated in place */
+        for (j = i + 1; j < num_points; j++) {
+            distance_squared = norms[i] + norms[j] - 2.0 * sym_matrix[i][j];
+            if (distance_squared < 0.0) {
+                distance_squared = 0.0; /* Cancellation between nearly equal points can leave a tiny negative value */
+            }
+            exponents[j - i - 1] = -(distance_squared / 2.0);
+        }
+        exp_batch(exponents, num_points - i - 1, exact_exp);
+        if (degrees != NULL) {
+            row_degrees = (partial_degrees != NULL) ? partial_degrees + (size_t)thread_number() * num_points : degrees;
+            for (j = i + 1; j < num_points; j++) {
+                /* Entry (i, j) also stands in for entry (j, i) of row j */
+                row_degrees[i] += sym_matrix[i][j];
+                row_degrees[j] += sym_matrix[i][j];
+            }
+        }
+    }
+    if (partial_degrees != NULL) {
+        for (t = 0; t < threads; t++) {
+            for (i = 0; i < num_points; i++) {
+                degrees[i] += partial_degrees[(size_t)t * num_points + i];
+            }
+        }
+        free(partial_degrees);
+    }
+    free(norms);
+    return 0;
+}
+#endif
+
+
+real **precision_function(similarity_matrix_with_degrees)(double **datapoints, int num_points, int point_dimension, double *degrees, int exact_exp) {
+    /* Creates similarity matrix as per project instructions, optionally summing its rows as they are produced (see similarity_matrix_fill).
+       Returns NULL on error.
+    Input: 
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.datapoints
+        - int num_points: Number of points in Datapoints, this is also the size of the similarity matrix as each entry in it corresponds to a point
+        - int point_dimension: Number of coordinates in each point.
+        - double degrees[]: Zero instantiated array of num_points, entry i ends up holding the sum of row i. Can be NULL if row sums aren't needed.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    Returns:
+        2D Similarity Matrix as a triangular matrix (see triangular_matrix_creation)
+    */
+    real **sym_matrix = precision_function(triangular_matrix_creation)(num_points);
+    if (sym_matrix == NULL) {
+        return NULL;
+    }
+    if (precision_function(similarity_matrix_fill)(datapoints, sym_matrix, num_points, point_dimension, degrees, exact_exp) != 0) {
+        precision_function(free_continuous_matrix)(sym_matrix);
+        return NULL;
+    }
+    return sym_matrix;
+}
+
+
+real **precision_function(similarity_matrix)(double **datapoints, int num_points, int point_dimension, int exact_exp) {
+    /* Creates similarity matrix as per project instructions. Returns NULL on error.
+    Input: 
+        - double Datapoints[][]: 2D Array, each element in it is a point who is itself an array of coordinates.datapoints
+        - int num_points: Number of points in Datapoints, this is also the size of the similarity matrix as each entry in it corresponds to a point
+        - int point_dimension: Number of coordinates in each point.
+        - int exact_exp: If nonzero the exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+    Returns:
+        2D Similarity Matrix as a triangular matrix (see triangular_matrix_creation)
+    */
+    return precision_function(similarity_matrix_with_degrees)(datapoints, num_points, point_dimension, NULL, exact_exp);
+}
+
+#undef real
+#undef precision_function
+#undef precision_single
@@ -6,438 +6,1293 @@
 #include "sym.h"
 #include "diagonal.h"
 #include "norm.h"
-#define beta 0.5
-#define epsilon 1e-4
-#define max_iter 300
+#include "sparse.h"
+#include "nystrom.h"
+#include "parallel.h"
+#include "mt19937.h"
+#include "nnls.h"
+#include "mapped.h"
+#include "gemm.h"
+#include "dataset.h"
+#include "reader.h"
+#include "writer.h"
+#include "symnmf.h"
+#define default_beta 0.5
+#define default_epsilon 1e-4
+#define default_max_iter 300
+#define extrapolation_initial 0.5
+#define extrapolation_growth 1.05
+#define extrapolation_cap_growth 1.01
+#define extrapolation_decay 1.5
+#define damping_growth 1.05
 
-typedef struct datapoints_wrapper {
+struct datapoints_wrapper {
     double **datapoints;
     int num_points;
     int dimension;
-} datapoints_wrapper;
+    struct dataset *dataset;
+};
 
+struct cli_options {
+    int neighbours;
+    double threshold;
+    int landmarks;
+    unsigned long seed;
+    int exact_exp;
+    int threads;
+    int single_precision;
+    const char *scratch;
+    const char *output;
+};
 
-void free_update_H_matrices(double **w_h_mult, double **h_t, double **h_h_t_mult, double **h_h_t_h_mult){
-    /* Frees up H matrices for convenience. Matrices can be NULL as free_continuous_matrix which is used here handles it. 
-    Input: 
-        - double prev_H[][]: Matrix 1 we are freeing.
-        - double h_t[][]: Matrix 2 we are freeing.
-        - double h_h_t_mult[][]: Matrix 3 we are freeing.
-        - double h_h_t_h_mult[][]: Matrix 4 we are freeing.
+/* The damped multiplicative update's elementwise parts in double precision, and in single precision with an _f32 suffix */
+#define real double
+#define precision_function(name) name
+#include "symnmf_template.c"
+#define real float
+#define precision_function(name) name ## _f32
+#include "symnmf_template.c"
+
+
+void free_solver_workspace(solver_workspace *workspace) {
+    /* Frees up solver workspace memory. Buffers can be NULL as free_continuous_matrix which is used here handles it.
+    Input:
+        - solver_workspace *workspace: Workspace whose memory we are freeing, can be NULL.
     */
-    free_continuous_matrix(w_h_mult);
-    free_continuous_matrix(h_t);
-    free_continuous_matrix(h_h_t_mult);
-    free_continuous_matrix(h_h_t_h_mult);
-    return;
+    if (workspace == NULL) return;
+    free_continuous_matrix(workspace->H[0]);
+    free_continuous_matrix(workspace->H[1]);
+    free_continuous_matrix(workspace->extrapolated_H);
+    free_continuous_matrix(workspace->w_h_mult);
+    free_continuous_matrix(workspace->h_t_h_mult);
+    free_continuous_matrix(workspace->h_h_t_h_mult);
+    free_continuous_matrix(workspace->projection);
+    free_continuous_matrix(workspace->partial_products);
+    free(workspace->nnls_scratch);
+    free(workspace->nnls_sets);
+    free(workspace->gemm_scratch);
+    free(workspace);
 }
 
 
-double **update_H(double **prev_H, double **W, int n, int k) {
-    /* Updates H to next iteration as per project instructions. Returns NULL on error.
-    Input: 
-        - double prev_H[][]: Previous iteration of H we are trying to update.
-        - double W[][]: Norm matrix we are using to calculate next iteration of H.
+void solver_options_defaults(solver_options *options) {
+    /* Fills solver options with the project instructions' solver: damped multiplicative updates with beta = 0.5, stopping once
+       ||H_t+1 - H_t||_F^2 < 1e-4 or after 300 iterations, without a callback.
+    Input:
+        - solver_options *options: Options to fill.
+    */
+    options->method = multiplicative_solver;
+    options->beta = default_beta;
+    options->epsilon = default_epsilon;
+    options->max_iter = default_max_iter;
+    options->callback = NULL;
+    options->callback_context = NULL;
+}
+
+
+solver_workspace *solver_workspace_creation(norm_operator *W, int n, int k, const solver_options *options) {
+    /* Allocates every buffer an iteration of the solver needs once, so that iterating is free of allocations. Returns NULL on error.
+    Input:
+        - norm_operator *W: Norm matrix the solver runs on, decides whether scratch for a low rank or mapped multiplication is needed.
         - int n: Size of norm matrix, number of rows in H.
         - int k: Number of columns in H.
+        - const solver_options *options: Options the workspace is solved with, copied into it. The alternating methods get per thread
+          scratch for their row subproblems and the symmetry penalty, the accelerated one a third H buffer for the extrapolated point.
+          Per thread scratch is sized for the current num_threads(), kept in the workspace so a later set_num_threads leaves the solve as is.
     Returns:
-        Next iteration of H. 
+        Workspace with two nxk H buffers used in turns (one holding the previous iteration, the other receiving the next one), nxk buffers
+        for W * H and H * H^T * H, a kxk triangular buffer for H^T * H, per thread gemm scratch unless W is sparse and room for ||W||_F^2.
     */
-    double **w_h_mult, **h_t, **h_h_t_mult, **h_h_t_h_mult, **next_H;
-    int i, j;
-    w_h_mult = matrix_multiplication(W, prev_H, n, n, k);
-    h_t = matrix_transpose(prev_H, n, k);
-    if (w_h_mult == NULL || h_t == NULL) {
-        free_update_H_matrices(w_h_mult, h_t, NULL, NULL);
+    int threads = num_threads();
+    solver_method method = options->method;
+    solver_workspace *workspace = malloc(sizeof(solver_workspace));
+    if (workspace == NULL) {
         return NULL;
     }
-    h_h_t_mult = matrix_multiplication(prev_H, h_t, n, k, n);
-    if (h_h_t_mult == NULL) {
-        free_update_H_matrices(w_h_mult, h_t, h_h_t_mult, NULL);
+    workspace->n = n;
+    workspace->k = k;
+    workspace->threads = threads;
+    workspace->options = *options;
+    /* Half of a bound on ||W||_2 keeps the alternating solvers' two factors together without slowing them down much */
+    workspace->symmetry_penalty = (method == anls_solver || method == hals_solver) ? 0.5 * norm_operator_max_row_sum(W) : 0.0;
+    workspace->damping = options->beta;
+    workspace->H[0] = continuous_matrix_creation(n, k);
+    workspace->H[1] = continuous_matrix_creation(n, k);
+    workspace->extrapolated_H = (method == accelerated_solver) ? continuous_matrix_creation(n, k) : NULL;
+    workspace->w_h_mult = continuous_matrix_creation(n, k);
+    workspace->h_t_h_mult = triangular_matrix_creation(k);
+    workspace->h_h_t_h_mult = (method == multiplicative_solver || method == accelerated_solver) ? continuous_matrix_creation(n, k) : NULL;
+    workspace->projection = (W->representation == low_rank_norm) ? continuous_matrix_creation(W->low_rank->rank, k) : NULL;
+    workspace->partial_products = (W->representation == mapped_norm && threads > 1) ? continuous_matrix_creation(threads * n, k) : NULL;
+    workspace->nnls_scratch = (method != anls_solver && method != hals_solver) ? NULL : malloc((size_t)threads * (k * k + 3 * k) * sizeof(double));
+    workspace->nnls_sets = (method == anls_solver) ? malloc((size_t)threads * 2 * k * sizeof(int)) : NULL;
+    workspace->gemm_scratch = (W->representation != sparse_norm) ? malloc((size_t)threads * gemm_scratch_size * sizeof(double)) : NULL;
+    /* The low rank form needs a rxr gram matrix of its own for ||W||_F^2, so it is calculated here while the stored forms, which need no
+       scratch, wait until an objective is asked for */
+    workspace->w_norm_squared = (W->representation == low_rank_norm) ? norm_operator_frobenius_squared(W) : -1.0;
+    if (workspace->H[0] == NULL || workspace->H[1] == NULL || workspace->w_h_mult == NULL || workspace->h_t_h_mult == NULL ||
+        (W->representation != sparse_norm && workspace->gemm_scratch == NULL) ||
+        (method == accelerated_solver && workspace->extrapolated_H == NULL) ||
+        ((method == multiplicative_solver || method == accelerated_solver) && workspace->h_h_t_h_mult == NULL) ||
+        (W->representation == low_rank_norm && (workspace->projection == NULL || workspace->w_norm_squared < 0.0)) ||
+        (W->representation == mapped_norm && threads > 1 && workspace->partial_products == NULL) ||
+        ((method == anls_solver || method == hals_solver) && (workspace->nnls_scratch == NULL || workspace->symmetry_penalty < 0.0)) || (method == anls_solver && workspace->nnls_sets == NULL)) {
+        free_solver_workspace(workspace);
         return NULL;
     }
-    h_h_t_h_mult = matrix_multiplication(h_h_t_mult, prev_H, n, n, k);
-    next_H = continuous_matrix_creation(n, k);
-    if (h_h_t_h_mult == NULL || next_H == NULL) {
-        free_update_H_matrices(w_h_mult, h_t, h_h_t_mult, h_h_t_h_mult);
-        free_continuous_matrix(next_H);
-        return NULL;
+    return workspace;
+}
+
+
+int solver_method_from_name(const char *name) {
+    /* Maps a solver's name to its method. Returns -1 for an unknown name.
+    Input:
+        - const char *name: "mu" (damped multiplicative updates), "anls" (alternating nonnegative least squares), "hals"
+          (hierarchical alternating least squares) or "amu" (accelerated multiplicative updates).
+    Returns:
+        The matching solver_method.
+    */
+    if (strcmp(name, "mu") == 0) return multiplicative_solver;
+    if (strcmp(name, "anls") == 0) return anls_solver;
+    if (strcmp(name, "hals") == 0) return hals_solver;
+    if (strcmp(name, "amu") == 0) return accelerated_solver;
+    return -1;
+}
+
+
+void norm_operator_multiplication(norm_operator *W, double **H, solver_workspace *workspace) {
+    /* Multiplies the norm matrix by H in whichever form the norm matrix is stored, into workspace->w_h_mult.
+    Input: 
+        - norm_operator *W: Norm matrix.
+        - double H[][]: Right matrix, has W->n rows and workspace->k columns.
+        - solver_workspace *workspace: Workspace holding the result buffer (and scratch for the low rank and mapped forms).
+    */
+    switch (W->representation) {
+        case dense_norm:
+            symmetric_matrix_multiplication(W->dense, H, workspace->w_h_mult, workspace->gemm_scratch, workspace->threads, W->n, workspace->k);
+            break;
+        case single_dense_norm:
+            symmetric_matrix_multiplication_mixed(W->single_dense, H, workspace->w_h_mult, workspace->gemm_scratch, workspace->threads, W->n, workspace->k);
+            break;
+        case sparse_norm:
+            sparse_matrix_multiplication(W->sparse, H, workspace->w_h_mult, workspace->k);
+            break;
+        case low_rank_norm:
+            low_rank_matrix_multiplication(W->low_rank, H, workspace->projection, workspace->w_h_mult, workspace->gemm_scratch, workspace->k);
+            break;
+        case mapped_norm:
+            mapped_matrix_multiplication(W->mapped, H, workspace->w_h_mult, workspace->partial_products, workspace->gemm_scratch, workspace->threads, workspace->k);
+            break;
     }
+}
+
+
+double norm_operator_frobenius_squared(norm_operator *W) {
+    /* Calculates ||W||_F^2 in whichever form the norm matrix is stored. For the low rank form W = G * G^T - S this is
+       ||G^T * G||_F^2 - 2 * sum_i s_i * ||g_i||^2 + sum_i s_i^2, which never forms an nxn matrix.
+    Input: 
+        - norm_operator *W: Norm matrix.
+    Returns:
+        Sum of the squares of W's entries.
+    */
+    int i, j, rank;
+    double row_sum, sum = 0.0;
+    double **factor_gram;
+    switch (W->representation) {
+        case dense_norm:
+        case mapped_norm: /* W->dense holds the mapped rows, a single pass in file order */
+            sum = symmetric_frobenius_squared(W->dense, W->n);
+            break;
+        case single_dense_norm:
+            sum = symmetric_frobenius_squared_f32(W->single_dense, W->n);
+            break;
+        case sparse_norm:
+            for (i = 0; i < W->sparse->nnz; i++) {
+                sum += W->sparse->values[i] * W->sparse->values[i];
+            }
+            break;
+        case low_rank_norm:
+            rank = W->low_rank->rank;
+            factor_gram = triangular_matrix_creation(rank);
+            if (factor_gram == NULL) {
+                return -1.0;
+            }
+            gram_matrix(W->low_rank->factor, factor_gram, W->n, rank);
+            for (i = 0; i < rank; i++) {
+                sum += factor_gram[i][i] * factor_gram[i][i];
+                for (j = i + 1; j < rank; j++) {
+                    sum += 2.0 * factor_gram[i][j] * factor_gram[i][j];
+                }
+            }
+            free_continuous_matrix(factor_gram);
+            for (i = 0; i < W->n; i++) {
+                row_sum = 0.0;
+                for (j = 0; j < rank; j++) {
+                    row_sum += W->low_rank->factor[i][j] * W->low_rank->factor[i][j];
+                }
+                sum += W->low_rank->diagonal_shift[i] * (W->low_rank->diagonal_shift[i] - 2.0 * row_sum);
+            }
+            break;
+    }
+    return sum;
+}
+
+
+double norm_operator_max_row_sum(norm_operator *W) {
+    /* Calculates max_i sum_j |W_ij|, which bounds W's spectral norm from above, in whichever form the norm matrix is stored. For the low rank
+       form the row sums of W itself, G * (G^T * 1) - S * 1, are used, its entries approximate a nonnegative matrix.
+    Input: 
+        - norm_operator *W: Norm matrix.
+    Returns:
+        The largest absolute row sum, -1.0 on error.
+    */
+    int i, j, rank;
+    double largest = 0.0, row_sum;
+    double *column_sums;
+    switch (W->representation) {
+        case dense_norm:
+        case mapped_norm:
+            largest = symmetric_max_row_sum(W->dense, W->n);
+            break;
+        case single_dense_norm:
+            largest = symmetric_max_row_sum_f32(W->single_dense, W->n);
+            break;
+        case sparse_norm:
+            for (i = 0; i < W->n; i++) {
+                row_sum = 0.0;
+                for (j = W->sparse->row_offsets[i]; j < W->sparse->row_offsets[i + 1]; j++) {
+                    row_sum += fabs(W->sparse->values[j]);
+                }
+                if (row_sum > largest) largest = row_sum;
+            }
+            break;
+        case low_rank_norm:
+            rank = W->low_rank->rank;
+            column_sums = calloc(rank, sizeof(double));
+            if (column_sums == NULL) {
+                return -1.0;
+            }
+            for (i = 0; i < W->n; i++) {
+                for (j = 0; j < rank; j++) {
+                    column_sums[j] += W->low_rank->factor[i][j];
+                }
+            }
+            for (i = 0; i < W->n; i++) {
+                row_sum = -W->low_rank->diagonal_shift[i];
+                for (j = 0; j < rank; j++) {
+                    row_sum += W->low_rank->factor[i][j] * column_sums[j];
+                }
+                if (fabs(row_sum) > largest) largest = fabs(row_sum);
+            }
+            free(column_sums);
+            break;
+    }
+    return largest;
+}
+
+
+double update_H(double **prev_H, double **next_H, norm_operator *W, solver_workspace *workspace, double *objective) {
+    /* Updates H to next iteration as per project instructions, all intermediate results go to the workspace's buffers.
+       The denominator H * H^T * H is computed as H * (H^T * H) around the kxk gram matrix, O(n * k^2) instead of O(n^2 * k) with an nxn
+       temporary, so W * H is the only part of the iteration whose cost grows with n^2. The loop writing the next iteration also sums the
+       squared change of every entry (the convergence distance), so it costs no pass over H of its own. The objective, when asked for, takes
+       one more O(n * k) pass summing tr(H^T * W * H) from the products already in the workspace.
+    Input: 
+        - double prev_H[][]: Previous iteration of H we are trying to update.
+        - double next_H[][]: nxk matrix the next iteration of H is written to, must not be prev_H.
+        - norm_operator *W: Norm matrix we are using to calculate next iteration of H.
+        - solver_workspace *workspace: Workspace allocated for W and H's dimensions, its damping is the step's beta (the options' beta unless
+          the accelerated solver adapts it).
+        - double *objective: If not NULL, set to ||W - H * H^T||_F^2 = ||W||_F^2 - 2 * tr(H^T * W * H) + ||H^T * H||_F^2 of prev_H
+          (-1.0 if ||W||_F^2 could not be calculated).
+    Returns:
+        ||next_H - prev_H||_F^2
+    */
+    int n = workspace->n, k = workspace->k;
+    double distance_squared;
+    norm_operator_multiplication(W, prev_H, workspace);
+    gram_matrix(prev_H, workspace->h_t_h_mult, n, k); /* H^T * H is symmetric, only its upper triangle is built */
+    matrix_symmetric_multiplication(prev_H, workspace->h_t_h_mult, workspace->h_h_t_h_mult, n, k);
+    distance_squared = multiplicative_step(prev_H, next_H, workspace->w_h_mult, workspace->h_h_t_h_mult, n, k, workspace->damping);
+    if (objective != NULL) {
+        *objective = objective_from_products(prev_H, W, workspace);
+    }
+    return distance_squared;
+}
+
+
+double update_H_alternating(double **prev_H, double **next_H, norm_operator *W, solver_workspace *workspace, double *objective) {
+    /* Updates H to the next iteration of symmetric ANLS or HALS (Kuang, Yun and Park), which relax SymNMF to
+       min ||W - H * Ht^T||_F^2 + alpha * ||H - Ht||_F^2 over two nonnegative factors and alternate between them. With Ht = prev_H fixed this is
+       a nonnegative least squares problem whose rows are independent: row i minimizes x^T * (Ht^T * Ht + alpha * I) * x - 2 * b_i^T * x with
+       b_i = (W * Ht + alpha * Ht)[i]. ANLS solves every row exactly (block principal pivoting), HALS takes one coordinate descent sweep from
+       prev_H's row, which is the column by column HALS update. The result then becomes Ht for the next iteration, so like update_H every
+       iteration costs one multiplication by W. alpha is the workspace's symmetry penalty, which pulls the two factors together. Like update_H it also returns the convergence distance and, if asked for, the objective of prev_H.
+    Input: 
+        - double prev_H[][]: Previous iteration of H we are trying to update.
+        - double next_H[][]: nxk matrix the next iteration of H is written to, must not be prev_H.
+        - norm_operator *W: Norm matrix we are using to calculate next iteration of H.
+        - solver_workspace *workspace: Workspace allocated for W and H's dimensions with an alternating method.
+        - double *objective: If not NULL, set to ||W - H * H^T||_F^2 of prev_H (-1.0 if ||W||_F^2 could not be calculated).
+    Returns:
+        ||next_H - prev_H||_F^2
+    */
+    int i, j;
+    int n = workspace->n, k = workspace->k;
+    double alpha = workspace->symmetry_penalty;
+    double difference, distance_squared = 0.0;
+    double *rhs, *scratch;
+    norm_operator_multiplication(W, prev_H, workspace);
+    gram_matrix(prev_H, workspace->h_t_h_mult, n, k);
+#ifdef _OPENMP
+    #pragma omp parallel for private(j, difference, rhs, scratch) reduction(+:distance_squared) schedule(dynamic, 64) num_threads(workspace->threads)
+#endif
     for (i = 0; i < n; i++) {
+        rhs = workspace->nnls_scratch + (size_t)thread_number() * (k * k + 3 * k);
+        scratch = rhs + k;
+        for (j = 0; j < k; j++) {
+            rhs[j] = workspace->w_h_mult[i][j] + alpha * prev_H[i][j];
+            next_H[i][j] = prev_H[i][j];
+        }
+        if (workspace->options.method != anls_solver ||
+            nnls_block_pivoting(workspace->h_t_h_mult, alpha, rhs, next_H[i], k, scratch, workspace->nnls_sets + (size_t)thread_number() * 2 * k) != 0) {
+            if (workspace->options.method == anls_solver) { /* Numerically singular subproblem, fall back to improving on prev_H's row */
+                for (j = 0; j < k; j++) {
+                    next_H[i][j] = prev_H[i][j];
+                }
+            }
+            nnls_coordinate_sweep(workspace->h_t_h_mult, alpha, rhs, next_H[i], k);
+        }
         for (j = 0; j < k; j++) {
-            next_H[i][j] = prev_H[i][j] * (1 - beta + beta*(w_h_mult[i][j]/h_h_t_h_mult[i][j]));
+            difference = next_H[i][j] - prev_H[i][j];
+            distance_squared += difference * difference;
         }
     }
-    free_update_H_matrices(w_h_mult, h_t, h_h_t_mult, h_h_t_h_mult);
-    return next_H;
-}   
+    if (objective != NULL) {
+        *objective = objective_from_products(prev_H, W, workspace);
+    }
+    return distance_squared;
+}
 
 
-double frobenius_norm_squared(double **matrix, int n, int k) {
-    /* Calculates squared frobenius norm of matrix. Returns -1.0 on error.
+double objective_from_products(double **H, norm_operator *W, solver_workspace *workspace) {
+    /* Calculates ||W - H * H^T||_F^2 = ||W||_F^2 - 2 * tr(H^T * W * H) + ||H^T * H||_F^2 from W * H and H^T * H already in the workspace,
+       calculating ||W||_F^2 the first time it is needed.
     Input: 
-        - double matrix[][]: Matrix we are trying to calculate frobenius norm of. 
-        - int n: Number of rows in matrix.
-        - int k: Number of columns in matrix.
+        - double H[][]: The H the workspace's products were calculated from.
+        - norm_operator *W: Norm matrix.
+        - solver_workspace *workspace: Workspace holding W * H and H^T * H.
     Returns:
-        Frobenius norm of given matrix. 
+        The objective, -1.0 if ||W||_F^2 could not be calculated.
     */
-    double **transpose;
-    double **m_t_mult;
-    double trace;
-    transpose = matrix_transpose(matrix, n, k);
-    if (transpose == NULL) {
-        return -1.0;
-    }
-    m_t_mult = matrix_multiplication(transpose, matrix, k, n, k);
-    if (m_t_mult == NULL) {
-        free_continuous_matrix(transpose);
-        return -1.0;
+    if (workspace->w_norm_squared < 0.0) {
+        workspace->w_norm_squared = norm_operator_frobenius_squared(W);
+        if (workspace->w_norm_squared < 0.0) {
+            return -1.0;
+        }
     }
-    trace = matrix_trace(m_t_mult, k);
-    free_continuous_matrix(transpose);
-    free_continuous_matrix(m_t_mult);
-    return trace;
+    return factorization_objective(H, workspace->w_h_mult, workspace->h_t_h_mult, workspace->n, workspace->k, workspace->w_norm_squared);
 }
 
 
-void converge_H_memory_freer(double **prev_H, double **cur_H, double **distance_matrix){
-    /* Frees up H matrices for convenience. Matrices can be NULL as free_continuous_matrix which is used here handles it. 
+double symnmf_objective(double **H, norm_operator *W, solver_workspace *workspace) {
+    /* Calculates ||W - H * H^T||_F^2 for any H, overwriting the workspace's products.
     Input: 
-        - double prev_H[][]: Matrix 1 we are freeing.
-        - double prev_H[][]: Matrix 2 we are freeing.
-        - double distance_matrix: Matrix 3 we are freeing.
+        - double H[][]: nxk matrix whose objective we are calculating.
+        - norm_operator *W: Norm matrix.
+        - solver_workspace *workspace: Workspace allocated for W and H's dimensions.
+    Returns:
+        The objective, -1.0 on error.
     */
-    free_continuous_matrix(prev_H);
-    free_continuous_matrix(cur_H);
-    free_continuous_matrix(distance_matrix);
+    norm_operator_multiplication(W, H, workspace);
+    gram_matrix(H, workspace->h_t_h_mult, workspace->n, workspace->k);
+    return objective_from_products(H, W, workspace);
 }
 
 
-double **converge_H(double **initial_H, double **W, int n, int k) {
-    /* Continuously updates H until either convergence or until reaching max iterations, as per project instructions. Returns NULL on error.
+int solver_iteration_report(solver_workspace *workspace, int iteration, double step, double objective, double start_time) {
+    /* Reports a finished iteration to the workspace options' callback, if there is one.
+    Input:
+        - solver_workspace *workspace: Workspace being solved on.
+        - int iteration: Index of the finished iteration, from 0.
+        - double step: ||H_t+1 - H_t||_F^2 of the iteration.
+        - double objective: ||W - H * H^T||_F^2 of the point the update was taken from.
+        - double start_time: wall_time when solving started.
+    Returns:
+        Nonzero if the callback asked to stop iterating, 0 otherwise (and without a callback).
+    */
+    if (workspace->options.callback == NULL) {
+        return 0;
+    }
+    return workspace->options.callback(iteration, step, objective, wall_time() - start_time, workspace->options.callback_context);
+}
+
+
+double **solve_H(double **initial_H, norm_operator *W, solver_workspace *workspace, double *objective) {
+    /* Continuously updates H until either convergence or until reaching max iterations, as per project instructions, on a given workspace.
+       Iterations use the workspace's options and alternate between its two H buffers instead of copying. The objective is only
+       calculated along with every update when there is a callback to report it to. Returns NULL on error.
     Input: 
-        - double Initial_H[][]: Initial H matrix we received from Python.
-        - double W[][]: Norm matrix.
-        - int n: Size of norm matrix, number of rows in H.
-        - int k: Number of columns in H.
+        - double Initial_H[][]: Initial H matrix, not modified.
+        - norm_operator *W: Norm matrix, dense, sparse or low rank.
+        - solver_workspace *workspace: Workspace allocated for W and H's dimensions, the buffer holding the result is taken out of it.
+        - double *objective: If not NULL, set to ||W - H * H^T||_F^2 of the final H.
     Returns:
-        Final iteration of H. 
+        Final iteration of H, owned by the caller.
     */
-    double **prev_H = NULL, **cur_H = NULL, **distance_matrix = NULL;
-    double frobenius_distance_squared;
-    int iteration;
-    prev_H = matrix_deep_copy(initial_H, n, k);
-    if (prev_H == NULL) {return NULL;}
-    for (iteration = 0; iteration < max_iter; iteration++) {
-        cur_H = update_H(prev_H, W, n, k);
-        if (cur_H == NULL) {
-            converge_H_memory_freer(prev_H, cur_H, distance_matrix);
-            return NULL;
+    double **final_H;
+    double frobenius_distance_squared, iteration_objective = 0.0, start_time = wall_time();
+    double *report_objective = (workspace->options.callback != NULL) ? &iteration_objective : NULL;
+    int i, j, iteration, current = 0;
+    int n = workspace->n, k = workspace->k;
+    if (workspace->options.method == accelerated_solver) {
+        return solve_H_accelerated(initial_H, W, workspace, objective);
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < k; j++) {
+            workspace->H[0][i][j] = initial_H[i][j];
         }
-        distance_matrix = matrix_subtraction(cur_H, prev_H, n, k);
-        if (distance_matrix == NULL) {
-            converge_H_memory_freer(prev_H, cur_H, distance_matrix);
+    }
+    for (iteration = 0; iteration < workspace->options.max_iter; iteration++) {
+        frobenius_distance_squared = (workspace->options.method == multiplicative_solver) ?
+            update_H(workspace->H[current], workspace->H[1 - current], W, workspace, report_objective) :
+            update_H_alternating(workspace->H[current], workspace->H[1 - current], W, workspace, report_objective);
+        current = 1 - current;
+        if (solver_iteration_report(workspace, iteration, frobenius_distance_squared, iteration_objective, start_time) != 0) {
+            break;
+        }
+        if (frobenius_distance_squared < workspace->options.epsilon) {
+            break;
+        }
+    }
+    final_H = workspace->H[current];
+    if (objective != NULL) {
+        *objective = symnmf_objective(final_H, W, workspace);
+        if (*objective < 0.0) {
             return NULL;
         }
-        frobenius_distance_squared = frobenius_norm_squared(distance_matrix, n, k);
-        free_continuous_matrix(prev_H);
-        free_continuous_matrix(distance_matrix);
-        if (frobenius_distance_squared == -1) {
-            free_continuous_matrix(cur_H);
+    }
+    workspace->H[current] = NULL; /* Handed over to the caller, not freed with the workspace */
+    return final_H;
+}
+
+
+double **solve_H_accelerated(double **initial_H, norm_operator *W, solver_workspace *workspace, double *objective) {
+    /* Runs the damped multiplicative update with extrapolation (Ang and Gillis): every update is taken from the extrapolated point
+       Y = H_t + weight * (H_t - H_t-1) instead of H_t, entries that would go negative are not extrapolated. The objective of Y comes with
+       the update for free. While it keeps decreasing both the extrapolation weight (up to a slowly growing cap) and the update's damping
+       (up to 1, the undamped rule) grow, once it rises the next step is taken from H_t itself, the weight is cut and capped at its last
+       value and the damping goes back to the options' beta. The convergence test is the same as solve_H's, on the change between consecutive H_t's.
+       Returns NULL on error.
+    Input: 
+        - double Initial_H[][]: Initial H matrix, not modified.
+        - norm_operator *W: Norm matrix, dense, sparse or low rank.
+        - solver_workspace *workspace: Workspace allocated for W and H's dimensions with the accelerated method.
+        - double *objective: If not NULL, set to ||W - H * H^T||_F^2 of the final H.
+    Returns:
+        Final iteration of H, owned by the caller.
+    */
+    double **final_H, **current_H, **next_H, **extrapolated_H = workspace->extrapolated_H;
+    double frobenius_distance_squared, difference, extrapolated_objective, previous_objective = 0.0, start_time = wall_time();
+    double weight = extrapolation_initial, weight_cap = 1.0, step_weight;
+    int i, j, iteration, current = 0;
+    int n = workspace->n, k = workspace->k;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < k; j++) {
+            workspace->H[0][i][j] = initial_H[i][j];
+            extrapolated_H[i][j] = initial_H[i][j];
+        }
+    }
+    workspace->damping = workspace->options.beta;
+    for (iteration = 0; iteration < workspace->options.max_iter; iteration++) {
+        current_H = workspace->H[current];
+        next_H = workspace->H[1 - current];
+        update_H(extrapolated_H, next_H, W, workspace, &extrapolated_objective);
+        if (extrapolated_objective < 0.0) {
             return NULL;
         }
-        if (frobenius_distance_squared < epsilon) {
+        if (iteration > 0 && extrapolated_objective > previous_objective) {
+            weight_cap = weight;
+            weight /= extrapolation_decay;
+            workspace->damping = workspace->options.beta;
+            step_weight = 0.0; /* Restart from the next H itself */
+        }
+        else {
+            weight = (weight * extrapolation_growth < weight_cap) ? weight * extrapolation_growth : weight_cap;
+            weight_cap = (weight_cap * extrapolation_cap_growth < 1.0) ? weight_cap * extrapolation_cap_growth : 1.0;
+            workspace->damping = (workspace->damping * damping_growth < 1.0) ? workspace->damping * damping_growth : 1.0;
+            step_weight = weight;
+        }
+        previous_objective = extrapolated_objective;
+        frobenius_distance_squared = 0.0;
+#ifdef _OPENMP
+        #pragma omp parallel for private(j, difference) reduction(+:frobenius_distance_squared) schedule(static) num_threads(num_threads())
+#endif
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < k; j++) {
+                difference = next_H[i][j] - current_H[i][j];
+                frobenius_distance_squared += difference * difference;
+                extrapolated_H[i][j] = next_H[i][j] + step_weight * difference;
+                if (extrapolated_H[i][j] <= 0.0) {
+                    extrapolated_H[i][j] = next_H[i][j];
+                }
+            }
+        }
+        current = 1 - current;
+        if (solver_iteration_report(workspace, iteration, frobenius_distance_squared, extrapolated_objective, start_time) != 0) {
             break;
         }
-        prev_H = cur_H;
+        if (frobenius_distance_squared < workspace->options.epsilon) {
+            break;
+        }
+    }
+    final_H = workspace->H[current];
+    if (objective != NULL) {
+        *objective = symnmf_objective(final_H, W, workspace);
+        if (*objective < 0.0) {
+            return NULL;
+        }
     }
-    return cur_H;
+    workspace->H[current] = NULL; /* Handed over to the caller, not freed with the workspace */
+    return final_H;
 }
 
 
-void datapoints_on_error_handler(datapoints_wrapper *datapoints){
-    /* Function to handle deallocating datapoints memory in case of error. Includes print message.
+double **converge_H(double **initial_H, norm_operator *W, int n, int k, const solver_options *options) {
+    /* Continuously updates H until either convergence or until reaching max iterations, as per project instructions. Returns NULL on error.
+       Every buffer is allocated once up front in a solver workspace.
     Input: 
-        - datapoints_wrapper *datapoints: datapoints wrapper.
+        - double Initial_H[][]: Initial H matrix we received from Python.
+        - norm_operator *W: Norm matrix, dense, sparse or low rank.
+        - int n: Size of norm matrix, number of rows in H.
+        - int k: Number of columns in H.
+        - const solver_options *options: Update rule, stopping criteria and callback, see solver_options_defaults for the project's.
+    Returns:
+        Final iteration of H. 
     */
-    printf("An Error Has Occurred\n");
-    free_matrix(datapoints->datapoints, datapoints->num_points);
-    free(datapoints);
+    double **final_H;
+    solver_workspace *workspace = solver_workspace_creation(W, n, k, options);
+    if (workspace == NULL) {return NULL;}
+    final_H = solve_H(initial_H, W, workspace, NULL);
+    free_solver_workspace(workspace);
+    return final_H;
 }
 
 
-void invalid_file_read_error_handler(FILE *file, datapoints_wrapper *wrapper, int row) {
-    /* Function to handle deallocating datapoints memory and file memory in case of error. Fully handles error's by deallocating memory and exiting.
+float **converge_H_f32(float **initial_H, float **W, int n, int k, const solver_options *options) {
+    /* Single precision counterpart of converge_H for a dense norm matrix: H, W * H, H^T * H and H * H^T * H are float, which halves their
+       memory traffic and doubles the width of the vectorized products, while the convergence distance and the objective reported to the
+       callback are summed in double. Only the damped multiplicative update has a single precision version. Returns NULL on error, or if the
+       options ask for another method.
     Input: 
-        - FILE *file: pointer to file we need to close.
-        - datapoints_wrapper *datapoints: datapoints wrapper.
-        - int row: current row file failed on so datapoints_on_error_handler can properly deallocate datapoints matrix.
+        - float Initial_H[][]: Initial nxk H matrix, not modified.
+        - float W[][]: nxn triangular norm matrix.
+        - int n: Size of norm matrix, number of rows in H.
+        - int k: Number of columns in H.
+        - const solver_options *options: Options as for converge_H, method must be multiplicative_solver.
+    Returns:
+        Final iteration of H.
     */
-    fclose(file);
-    wrapper->num_points = row;
-    datapoints_on_error_handler(wrapper); 
-    exit(EXIT_FAILURE);
+    float **H[2], **w_h_mult, **h_t_h_mult, **h_h_t_h_mult, *gemm_scratch;
+    double frobenius_distance_squared, objective = 0.0, w_norm_squared = 0.0, start_time = wall_time();
+    int i, j, iteration, current = 0, threads = num_threads();
+    if (options->method != multiplicative_solver) {
+        return NULL;
+    }
+    H[0] = continuous_matrix_creation_f32(n, k);
+    H[1] = continuous_matrix_creation_f32(n, k);
+    w_h_mult = continuous_matrix_creation_f32(n, k);
+    h_t_h_mult = triangular_matrix_creation_f32(k);
+    h_h_t_h_mult = continuous_matrix_creation_f32(n, k);
+    gemm_scratch = malloc((size_t)threads * gemm_scratch_size * sizeof(float));
+    if (H[0] == NULL || H[1] == NULL || w_h_mult == NULL || h_t_h_mult == NULL || h_h_t_h_mult == NULL || gemm_scratch == NULL) {
+        free_continuous_matrix_f32(H[0]);
+        free_continuous_matrix_f32(H[1]);
+        free_continuous_matrix_f32(w_h_mult);
+        free_continuous_matrix_f32(h_t_h_mult);
+        free_continuous_matrix_f32(h_h_t_h_mult);
+        free(gemm_scratch);
+        return NULL;
+    }
+    if (options->callback != NULL) {
+        w_norm_squared = symmetric_frobenius_squared_f32(W, n);
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < k; j++) {
+            H[0][i][j] = initial_H[i][j];
+        }
+    }
+    for (iteration = 0; iteration < options->max_iter; iteration++) {
+        symmetric_matrix_multiplication_f32(W, H[current], w_h_mult, gemm_scratch, threads, n, k);
+        gram_matrix_f32(H[current], h_t_h_mult, n, k);
+        matrix_symmetric_multiplication_f32(H[current], h_t_h_mult, h_h_t_h_mult, n, k);
+        frobenius_distance_squared = multiplicative_step_f32(H[current], H[1 - current], w_h_mult, h_h_t_h_mult, n, k, options->beta);
+        if (options->callback != NULL) {
+            objective = factorization_objective_f32(H[current], w_h_mult, h_t_h_mult, n, k, w_norm_squared);
+        }
+        current = 1 - current;
+        if (options->callback != NULL &&
+            options->callback(iteration, frobenius_distance_squared, objective, wall_time() - start_time, options->callback_context) != 0) {
+            break;
+        }
+        if (frobenius_distance_squared < options->epsilon) {
+            break;
+        }
+    }
+    free_continuous_matrix_f32(H[1 - current]);
+    free_continuous_matrix_f32(w_h_mult);
+    free_continuous_matrix_f32(h_t_h_mult);
+    free_continuous_matrix_f32(h_h_t_h_mult);
+    free(gemm_scratch);
+    return H[current];
 }
 
 
-void invalid_file_read_error_handler_simple_case(FILE *file, datapoints_wrapper *wrapper) {
-    /* Function to handle deallocating datapoints memory and file memory in case of error. Fully handles error's by deallocating memory and exiting.
+double norm_operator_sum(norm_operator *W) {
+    /* Calculates the sum of all of W's entries in whichever form the norm matrix is stored, for the low rank form W = G * G^T - S this is
+       ||G^T * 1||^2 - sum_i s_i.
     Input: 
-        - FILE *file: pointer to file we need to close.
-        - datapoints_wrapper *datapoints: datapoints wrapper.
+        - norm_operator *W: Norm matrix.
+    Returns:
+        Sum of W's entries.
     */
-    fclose(file);
-    datapoints_on_error_handler(wrapper); 
-    exit(EXIT_FAILURE);
+    int i, j, rank;
+    double column_sum, sum = 0.0;
+    switch (W->representation) {
+        case dense_norm:
+        case mapped_norm:
+            sum = symmetric_sum(W->dense, W->n);
+            break;
+        case single_dense_norm:
+            sum = symmetric_sum_f32(W->single_dense, W->n);
+            break;
+        case sparse_norm:
+            for (i = 0; i < W->sparse->nnz; i++) {
+                sum += W->sparse->values[i];
+            }
+            break;
+        case low_rank_norm:
+            rank = W->low_rank->rank;
+            for (j = 0; j < rank; j++) {
+                column_sum = 0.0;
+                for (i = 0; i < W->n; i++) {
+                    column_sum += W->low_rank->factor[i][j];
+                }
+                sum += column_sum * column_sum;
+            }
+            for (i = 0; i < W->n; i++) {
+                sum -= W->low_rank->diagonal_shift[i];
+            }
+            break;
+    }
+    return sum;
 }
 
 
-datapoints_wrapper* initialize_data(const char *filename) {
-    /* Initializes a datapoints wrapper in order to read datapoints from file. Fully handles errors by deallocating memory and exiting program.
+double **initial_H_creation(norm_operator *W, int n, int k, unsigned long seed) {
+    /* Creates an initial H as per project instructions, entries drawn uniformly from [0, 2 * sqrt(m / k)] with m the average entry of W.
+       Draws come from a Mersenne Twister seeded like numpy's np.random.seed, in the same order as np.random.uniform(size=(n, k)), so a seed
+       gives the same H as the Python initialization up to the last bits of m. Returns NULL on error.
     Input: 
-        - char[] filename: string filepath to .txt file containing datapoints
+        - norm_operator *W: Norm matrix.
+        - int n: Size of norm matrix, number of rows in H.
+        - int k: Number of columns in H.
+        - unsigned long seed: Seed of the random generator.
     Returns:
-        Initialized datapoint wrapper. 
+        nxk initial H.
     */
-    FILE *file = fopen(filename, "r");
-    int rows = 0;
-    char line[1023];
-    datapoints_wrapper *wrapper;
-
-    if (file) {
-        while (fgets(line, sizeof(line), file)) {
-            if (line[0] != '\n') rows++;
-        }
-        rewind(file); 
+    int i, j;
+    double upper_bound;
+    mt19937_state state;
+    double **initial_H = continuous_matrix_creation(n, k);
+    if (initial_H == NULL) {
+        return NULL;
     }
-    if (!file || rows == 0) {
-        printf("An Error Has Occurred\n");
-        exit(EXIT_FAILURE);
+    upper_bound = 2.0 * sqrt(norm_operator_sum(W) / ((double)n * n) / k);
+    mt19937_seed(&state, seed);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < k; j++) {
+            initial_H[i][j] = upper_bound * mt19937_uniform(&state);
+        }
     }
+    return initial_H;
+}
 
-    wrapper = malloc(sizeof(datapoints_wrapper));
-    wrapper->datapoints = malloc(rows * sizeof(double*));
-    if (wrapper->datapoints == NULL) {
-        printf("An Error Has Occurred\n");
-        exit(EXIT_FAILURE);
+
+double **solve_restart(norm_operator *W, int n, int k, unsigned long seed, const solver_options *options, double *objective) {
+    /* Runs one restart of converge_H_restarts, from initial_H_creation with the given seed and on a workspace of its own. Returns NULL on error.
+    Input:
+        - norm_operator *W: Norm matrix, dense, sparse or low rank.
+        - int n: Size of norm matrix, number of rows in H.
+        - int k: Number of columns in H.
+        - unsigned long seed: Seed of the initial H.
+        - const solver_options *options: Options the restart is solved with.
+        - double *objective: Set to ||W - H * H^T||_F^2 of the final H.
+    Returns:
+        Final iteration of H.
+    */
+    double **H = NULL;
+    double **initial_H = initial_H_creation(W, n, k, seed);
+    solver_workspace *workspace = solver_workspace_creation(W, n, k, options);
+    if (initial_H != NULL && workspace != NULL) {
+        H = solve_H(initial_H, W, workspace, objective);
     }
-    wrapper->num_points = rows;
-    fclose(file);
-    return wrapper;
+    free_continuous_matrix(initial_H);
+    free_solver_workspace(workspace);
+    return H;
 }
 
 
-void determine_data_dimension(FILE *file, datapoints_wrapper *wrapper) {
-    /* Reads the first data line to determine point dimension and stores it in the wrapper. Fully handles error's by deallocating memory and exiting.
-    Input:
-        - FILE *file: Pointer to the opened input file.
-        - datapoints_wrapper *wrapper: Pointer to the wrapper to store dimension in.
+double **converge_H_restarts(norm_operator *W, int n, int k, int restarts, unsigned long seed, const solver_options *options, double *best_objective) {
+    /* Runs SymNMF from several initial H's and keeps the one reaching the lowest ||W - H * H^T||_F^2. Restart r starts from
+       initial_H_creation with seed + r. Restarts are split between the T threads in whole batches of T, each restart of a batch runs on its
+       own thread (with its own workspace, all sharing the read only W) and its kernels on that thread alone, as a parallel region inside
+       another one only gets a single thread. The restarts left over (all of them when there are fewer than T) run one after another with
+       every kernel on all T threads, so a few restarts on many cores are never slower than one. Ties go to the lowest r, so the choice
+       does not depend on the number of threads. Returns NULL on error.
+    Input: 
+        - norm_operator *W: Norm matrix, dense, sparse or low rank.
+        - int n: Size of norm matrix, number of rows in H.
+        - int k: Number of columns in H.
+        - int restarts: Number of restarts, at least 1.
+        - unsigned long seed: Seed of the first restart.
+        - const solver_options *options: Options every restart is solved with. With a callback restarts run one after another, so that it
+          is never called concurrently.
+        - double *best_objective: If not NULL, set to the objective of the returned H.
+    Returns:
+        Final iteration of H of the best restart.
     */
-    char line[1024];
-    char *line_copy = NULL;
-    char *token;
-    int cols = 0;
-    size_t line_len;
-    while (fgets(line, sizeof(line), file) != NULL) {
-        if (line[0] != '\n') {
-            break; 
-        }
+    int r, best = -1, failed = 0;
+    int threads = num_threads();
+    int concurrent_restarts = (threads > 1 && options->callback == NULL) ? restarts - restarts % threads : 0;
+    double **best_H;
+    double ***restart_H = malloc(restarts * sizeof(double **));
+    double *objectives = malloc(restarts * sizeof(double));
+    if (restart_H == NULL || objectives == NULL) {
+        free(restart_H);
+        free(objectives);
+        return NULL;
     }
-    if (line[0] == '\n' || feof(file) || ferror(file)) {
-        invalid_file_read_error_handler_simple_case(file, wrapper);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+    for (r = 0; r < concurrent_restarts; r++) {
+        restart_H[r] = solve_restart(W, n, k, seed + r, options, &objectives[r]);
     }
-    line_len = strlen(line) + 1; 
-    line_copy = malloc(line_len); 
-    if (line_copy == NULL) { 
-        invalid_file_read_error_handler_simple_case(file, wrapper);
+    for (r = concurrent_restarts; r < restarts; r++) {
+        restart_H[r] = solve_restart(W, n, k, seed + r, options, &objectives[r]);
     }
-    strcpy(line_copy, line); 
-    if (line_copy == NULL) {
-        invalid_file_read_error_handler_simple_case(file, wrapper);
+    for (r = 0; r < restarts; r++) {
+        if (restart_H[r] == NULL) {
+            failed = 1;
+        }
+        else if (best == -1 || objectives[r] < objectives[best]) {
+            best = r;
+        }
     }
-    token = strtok(line_copy, ",");
-    while (token != NULL) {
-        cols++;
-        token = strtok(NULL, ",");
+    best_H = (failed || best == -1) ? NULL : restart_H[best];
+    if (best_H != NULL && best_objective != NULL) {
+        *best_objective = objectives[best];
     }
-    free(line_copy); 
-    if (cols <= 0) { 
-        invalid_file_read_error_handler_simple_case(file, wrapper);
+    for (r = 0; r < restarts; r++) {
+        if (restart_H[r] != best_H) {
+            free_continuous_matrix(restart_H[r]);
+        }
     }
-    wrapper->dimension = cols;
+    free(restart_H);
+    free(objectives);
+    return best_H;
 }
 
 
-void read_and_store_datapoints(FILE *file, datapoints_wrapper *wrapper) {
-    /* Reads data points from file, allocates rows, and stores values. Exits on error.
+double **fit_H(double **datapoints, int n, int d, int k, int precision, int exact_exp, int restarts, unsigned long seed, const solver_options *options) {
+    /* Runs SymNMF end to end from the datapoints, with the norm matrix built, initialized from and solved on without ever leaving C: W is
+       calculated with the fused kernel, initial H's are created with initial_H_creation (seed, seed + 1, ... for the restarts) and the
+       best restart is kept, see converge_H_restarts. In mixed precision W is built in float directly (see fused_norm_matrix_mixed), its
+       entries are those of the double precision norm matrix up to rounding. Returns NULL on error.
     Input:
-        - FILE *file: Pointer to the opened input file (positioned correctly).
-        - datapoints_wrapper *wrapper: Pointer to the wrapper to populate.
-    */
-    char line[1024];
-    char *token;
-    int row = 0;
-    int col;
-    while (fgets(line, sizeof(line), file)) {
-        if (line[0] == '\n') continue;
-        if (row >= wrapper->num_points) {
-            invalid_file_read_error_handler(file, wrapper, row);
-        }
-        wrapper->datapoints[row] = malloc(wrapper->dimension * sizeof(double));
-        if (wrapper->datapoints[row] == NULL) {
-            invalid_file_read_error_handler(file, wrapper, row);
-        }
-        token = strtok(line, ","); 
-        for (col = 0; col < wrapper->dimension; ++col) {
-            if (token == NULL) { 
-                invalid_file_read_error_handler(file, wrapper, row + 1); /* Row + 1 to deallocate the additional row that was allocated whose line reading failed*/
+        - double datapoints[][]: nxd datapoints.
+        - int n: Number of datapoints.
+        - int d: Dimension of the datapoints.
+        - int k: Number of columns in H.
+        - int precision: 0 for double, 1 for single (W and H float, only one restart and the multiplicative update) or 2 for mixed (W
+          float while H and every reduction stay double), as the --precision option.
+        - int exact_exp: If nonzero W's exponentials go through libm's exp (bit exact runs) instead of the vectorized kernel, see exp_batch.
+        - int restarts: Number of restarts, at least 1.
+        - unsigned long seed: Seed of the first restart's initial H.
+        - const solver_options *options: Options every restart is solved with.
+    Returns:
+        nxk final iteration of H (of the best restart).
+    */
+    int i, j;
+    norm_operator W;
+    double **H = NULL, **initial_H = NULL;
+    float **initial_H_f32 = NULL, **H_f32 = NULL;
+    if (precision == 1 && restarts != 1) {
+        return NULL;
+    }
+    W.representation = (precision == 0) ? dense_norm : single_dense_norm;
+    W.n = n;
+    W.dense = (precision == 0) ? fused_norm_matrix(datapoints, n, d, exact_exp) : NULL;
+    W.single_dense = (precision == 1) ? fused_norm_matrix_f32(datapoints, n, d, exact_exp) :
+                     (precision == 2) ? fused_norm_matrix_mixed(datapoints, n, d, exact_exp) : NULL;
+    W.sparse = NULL;
+    W.low_rank = NULL;
+    W.mapped = NULL;
+    if (W.dense == NULL && W.single_dense == NULL) {
+        return NULL;
+    }
+    if (precision != 1) {
+        H = converge_H_restarts(&W, n, k, restarts, seed, options, NULL);
+        free_continuous_matrix(W.dense);
+        free_continuous_matrix_f32(W.single_dense);
+        return H;
+    }
+    initial_H = initial_H_creation(&W, n, k, seed);
+    initial_H_f32 = (initial_H != NULL) ? continuous_matrix_creation_f32(n, k) : NULL;
+    if (initial_H_f32 != NULL) {
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < k; j++) {
+                initial_H_f32[i][j] = (float)initial_H[i][j];
             }
-            wrapper->datapoints[row][col] = atof(token);
-            token = strtok(NULL, ",");
         }
-        row++;
+        H_f32 = converge_H_f32(initial_H_f32, W.single_dense, n, k, options);
     }
-    if (row != wrapper->num_points) {
-        invalid_file_read_error_handler(file, wrapper, row);
+    H = (H_f32 != NULL) ? continuous_matrix_creation(n, k) : NULL;
+    for (i = 0; H != NULL && i < n; i++) {
+        for (j = 0; j < k; j++) {
+            H[i][j] = H_f32[i][j];
+        }
     }
+    free_continuous_matrix(initial_H);
+    free_continuous_matrix_f32(initial_H_f32);
+    free_continuous_matrix_f32(H_f32);
+    free_continuous_matrix_f32(W.single_dense);
+    return H;
 }
 
 
-void populate_data(datapoints_wrapper *wrapper, const char *filename) {
-    /* Main function to populate datapoints wrapper from file. Orchestrates dimension determination and data reading via helpers. 
-    Fully handles error's by deallocating memory and exiting.   
+void free_datapoints(datapoints_wrapper *datapoints) {
+    /* Frees up datapoints memory, whether the points were read from a text file or mapped from a binary dataset.
     Input: 
-        - datapoints_wrapper *wrapper: initialized datapoints wrapper.
-        - char[] filename: string filepath to .txt file containing datapoints
+        - datapoints_wrapper *datapoints: datapoints wrapper.
     */
-    FILE *file = fopen(filename, "r");
+    if (datapoints->dataset != NULL) {
+        free_dataset(datapoints->dataset);
+    }
+    else {
+        free_continuous_matrix(datapoints->datapoints);
+    }
+    free(datapoints);
+}
 
-    if (!file) { 
-        datapoints_on_error_handler(wrapper); 
-        exit(EXIT_FAILURE); 
-    }    
 
-    determine_data_dimension(file, wrapper); /* Sets wrapper->dimension */
+void datapoints_on_error_handler(datapoints_wrapper *datapoints){
+    /* Function to handle deallocating datapoints memory in case of error. Includes print message.
+    Input: 
+        - datapoints_wrapper *datapoints: datapoints wrapper.
+    */
+    printf("An Error Has Occurred\n");
+    free_datapoints(datapoints);
+}
 
-    rewind(file); /* Reset file pointer for full read */
 
-    read_and_store_datapoints(file, wrapper); /* Allocates rows and reads data */
+datapoints_wrapper* read_data(const char *filename) {
+    /* Creates a datapoints wrapper from a comma separated text file, read in a single pass (see read_datapoints). Fully handles errors by
+       deallocating memory and exiting program.
+    Input: 
+        - char[] filename: string filepath to .txt file containing datapoints
+    Returns:
+        Populated datapoint wrapper. 
+    */
+    datapoints_wrapper *wrapper = malloc(sizeof(datapoints_wrapper));
+    if (wrapper == NULL) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    wrapper->dataset = NULL;
+    wrapper->datapoints = read_datapoints(filename, &wrapper->num_points, &wrapper->dimension);
+    if (wrapper->datapoints == NULL) {
+        free(wrapper);
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    return wrapper;
+}
+
 
-    fclose(file); 
-    return; 
+datapoints_wrapper* load_dataset(const char *filename) {
+    /* Creates a datapoints wrapper over a binary dataset (see dataset.c), the points are memory mapped instead of read and parsed.
+       Fully handles errors by deallocating memory and exiting program.
+    Input: 
+        - char[] filename: string filepath to the binary dataset
+    Returns:
+        Populated datapoint wrapper. 
+    */
+    datapoints_wrapper *wrapper = malloc(sizeof(datapoints_wrapper));
+    if (wrapper == NULL) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    wrapper->dataset = dataset_open(filename);
+    if (wrapper->dataset == NULL) {
+        free(wrapper);
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    wrapper->datapoints = wrapper->dataset->rows;
+    wrapper->num_points = wrapper->dataset->n;
+    wrapper->dimension = wrapper->dataset->d;
+    return wrapper;
 }
 
 
-void sym(datapoints_wrapper *datapoints) {
+void convert(datapoints_wrapper *datapoints, cli_options *options) {
+    /* Wrapper function to write the datapoints as a binary dataset that later runs can map instead of parse. Fully handles errors by
+       deallocating memory and exiting.
+    Input: 
+        - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, holds the output path and whether the points are stored as float or double.
+    */
+    int element_size = options->single_precision ? (int)sizeof(float) : (int)sizeof(double);
+    if (dataset_write(options->output, datapoints->datapoints, datapoints->num_points, datapoints->dimension, element_size) != 0) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void sym(datapoints_wrapper *datapoints, cli_options *options) {
     /* Wrapper function to calculate similarity matrix as per project instructions. Fully handles errors by deallocating memory and exiting.
     Input: 
         - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, decides whether the matrix is calculated in single or double precision.
     */
-    double **sym_matrix;
+    double **sym_matrix = NULL;
+    float **sym_matrix_f32 = NULL;
     int n = datapoints->num_points;
     int d = datapoints->dimension;
-    sym_matrix = similarity_matrix(datapoints->datapoints, n, d);
-    if (sym_matrix == NULL) {
+    int failed;
+    if (options->single_precision) {
+        sym_matrix_f32 = similarity_matrix_f32(datapoints->datapoints, n, d, options->exact_exp);
+    }
+    else {
+        sym_matrix = similarity_matrix(datapoints->datapoints, n, d, options->exact_exp);
+    }
+    if (sym_matrix == NULL && sym_matrix_f32 == NULL) {
         datapoints_on_error_handler(datapoints);
         exit(EXIT_FAILURE);
     }
-    print_matrix(sym_matrix, n, n);
+    failed = options->single_precision ? print_symmetric_matrix_f32(sym_matrix_f32, n) : print_symmetric_matrix(sym_matrix, n);
+    free_continuous_matrix_f32(sym_matrix_f32);
     free_continuous_matrix(sym_matrix);
+    if (failed) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
 }
 
 
-void ddg(datapoints_wrapper *datapoints) {
+void ddg(datapoints_wrapper *datapoints, cli_options *options) {
     /* Wrapper function to calculate diagonal matrix as per project instructions. Fully handles errors by deallocating memory and exiting.
     Input: 
         - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, the degrees are summed in double precision whatever the precision.
     */
-    double **sym_matrix;
-    double **diag_matrix;
+    double *degrees;
     int n = datapoints->num_points;
     int d = datapoints->dimension;
-    sym_matrix = similarity_matrix(datapoints->datapoints, n, d);
-    if (sym_matrix == NULL) {
+    degrees = diagonal_vector(datapoints->datapoints, n, d, options->exact_exp);
+    if (degrees == NULL) {
         datapoints_on_error_handler(datapoints);
         exit(EXIT_FAILURE);
     }
-    diag_matrix = diagonal_matrix(sym_matrix, n);
-    if (diag_matrix == NULL) {
-        free_continuous_matrix(sym_matrix);
+    if (print_diagonal_matrix(degrees, n) != 0) {
+        free(degrees);
         datapoints_on_error_handler(datapoints);
         exit(EXIT_FAILURE);
     }
-    print_matrix(diag_matrix, n, n);
-    free_continuous_matrix(sym_matrix);
-    free_continuous_matrix(diag_matrix);
+    free(degrees);
 }
 
 
-void norm(datapoints_wrapper *datapoints) {
+void norm(datapoints_wrapper *datapoints, cli_options *options) {
     /* Wrapper function to calculate norm matrix as per project instructions. Fully handles errors by deallocating memory and exiting.
     Input: 
         - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, decides whether the matrix is calculated in single or double precision.
     */
-    double **sym_matrix;
-    double **diag_matrix;
-    double **normal_matrix;
+    double **normal_matrix = NULL;
+    float **normal_matrix_f32 = NULL;
     int n = datapoints->num_points;
     int d = datapoints->dimension;
-    sym_matrix = similarity_matrix(datapoints->datapoints, n, d);
-    if (sym_matrix == NULL) {
+    int failed;
+    if (options->single_precision) {
+        normal_matrix_f32 = fused_norm_matrix_f32(datapoints->datapoints, n, d, options->exact_exp);
+    }
+    else {
+        normal_matrix = fused_norm_matrix(datapoints->datapoints, n, d, options->exact_exp);
+    }
+    if (normal_matrix == NULL && normal_matrix_f32 == NULL) {
         datapoints_on_error_handler(datapoints);
         exit(EXIT_FAILURE);
     }
-    diag_matrix = diagonal_matrix(sym_matrix, n);
-    if (diag_matrix == NULL) {
-        free_continuous_matrix(sym_matrix);
+    failed = options->single_precision ? print_symmetric_matrix_f32(normal_matrix_f32, n) : print_symmetric_matrix(normal_matrix, n);
+    free_continuous_matrix_f32(normal_matrix_f32);
+    free_continuous_matrix(normal_matrix);
+    if (failed) {
         datapoints_on_error_handler(datapoints);
         exit(EXIT_FAILURE);
     }
-    normal_matrix = norm_matrix(sym_matrix, diag_matrix, n);
-    if (normal_matrix == NULL) {
-        free_continuous_matrix(sym_matrix);
-        free_continuous_matrix(diag_matrix);
+}
+
+
+void sparse_goals(datapoints_wrapper *datapoints, cli_options *options, const char *goal) {
+    /* Wrapper function to calculate the sparse versions of the similarity, diagonal or norm matrix, printing the requested one as a full matrix.
+       Fully handles errors by deallocating memory and exiting.
+    Input: 
+        - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, holds the neighbours and threshold of the sparse similarity matrix.
+        - const char *goal: One of "sym", "ddg" or "norm".
+    */
+    csr_matrix *sparse_matrix;
+    double *degrees = NULL;
+    int n = datapoints->num_points;
+    int d = datapoints->dimension;
+    int failed;
+    sparse_matrix = sparse_similarity_matrix(datapoints->datapoints, n, d, options->neighbours, options->threshold);
+    if (sparse_matrix == NULL) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(goal, "sym") == 0) {
+        failed = print_sparse_matrix(sparse_matrix);
+    }
+    else {
+        degrees = sparse_diagonal(sparse_matrix);
+        failed = (degrees == NULL) || ((strcmp(goal, "ddg") == 0) ? print_diagonal_matrix(degrees, n) : print_sparse_matrix(sparse_norm_matrix(sparse_matrix, degrees)));
+    }
+    free_csr_matrix(sparse_matrix);
+    free(degrees);
+    if (failed) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void low_rank_goals(datapoints_wrapper *datapoints, cli_options *options, const char *goal) {
+    /* Wrapper function to calculate the Nystrom (low rank) approximations of the similarity, diagonal or norm matrix, printing the requested one
+       as a full matrix. Fully handles errors by deallocating memory and exiting.
+    Input: 
+        - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, holds the number of landmarks and their sampling seed.
+        - const char *goal: One of "sym", "ddg" or "norm".
+    */
+    low_rank_matrix *low_rank;
+    double *degrees = NULL;
+    int n = datapoints->num_points;
+    int d = datapoints->dimension;
+    int failed;
+    low_rank = nystrom_similarity_matrix(datapoints->datapoints, n, d, options->landmarks, options->seed);
+    if (low_rank == NULL) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(goal, "sym") == 0) {
+        failed = print_low_rank_matrix(low_rank);
+    }
+    else {
+        degrees = low_rank_diagonal(low_rank);
+        failed = (degrees == NULL) || ((strcmp(goal, "ddg") == 0) ? print_diagonal_matrix(degrees, n) : print_low_rank_matrix(low_rank_norm_matrix(low_rank, degrees)));
+    }
+    free_low_rank_matrix(low_rank);
+    free(degrees);
+    if (failed) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void mapped_goals(datapoints_wrapper *datapoints, cli_options *options, const char *goal) {
+    /* Wrapper function to calculate the similarity, diagonal or norm matrix into a memory mapped file in the scratch directory instead of
+       memory, so the output is not limited by memory. Fully handles errors by deallocating memory and exiting.
+    Input: 
+        - datapoints_wrapper *datapoints: datapoints wrapper.
+        - cli_options *options: User options, holds the scratch directory.
+        - const char *goal: One of "sym", "ddg" or "norm".
+    */
+    mapped_matrix *matrix;
+    double *degrees;
+    int n = datapoints->num_points;
+    int d = datapoints->dimension;
+    int failed;
+    degrees = calloc(n, sizeof(double));
+    if (degrees == NULL) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+    matrix = mapped_similarity_matrix(datapoints->datapoints, n, d, options->scratch, degrees, options->exact_exp);
+    if (matrix == NULL) {
+        free(degrees);
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(goal, "ddg") == 0) {
+        failed = print_diagonal_matrix(degrees, n);
+    }
+    else {
+        if (strcmp(goal, "norm") == 0) {
+            norm_matrix(matrix->rows, degrees, n);
+        }
+        failed = print_symmetric_matrix(matrix->rows, n);
+    }
+    free_mapped_matrix(matrix);
+    free(degrees);
+    if (failed) {
         datapoints_on_error_handler(datapoints);
         exit(EXIT_FAILURE);
     }
-    print_matrix(normal_matrix, n, n);
-    free_continuous_matrix(sym_matrix);
-    free_continuous_matrix(diag_matrix);
-    free_continuous_matrix(normal_matrix);
+}
+
+
+void parse_options(int argc, char **argv, cli_options *options) {
+    /* Parses the optional arguments following the goal and filepath, each in the form --name=value. Fully handles errors by printing and exiting.
+       Supported options:
+        - --neighbours=K: Keep only each point's K nearest neighbours in the similarity matrix (sparse mode).
+        - --threshold=T: Keep only similarity entries of at least T, 0 < T <= 1, among the nearest neighbours when --neighbours is also given (sparse mode).
+        - --landmarks=M: Approximate the similarity matrix from M sampled landmark points (Nystrom low rank mode).
+        - --seed=S: Seed of the landmark sampling, defaults to 1234.
+        - --exact-exp: Evaluate the similarity matrix's exponentials with libm instead of the vectorized kernel (bit exact runs).
+        - --threads=T: Number of threads the parallel kernels use, overrides the SYMNMF_NUM_THREADS and OMP_NUM_THREADS environment variables.
+        - --precision=P: "double" (the default) or "single", the dense similarity, diagonal and norm matrices are calculated and stored as
+          float in single precision.
+        - --scratch=DIR: Calculate the dense matrices into a memory mapped file created (and deleted) in directory DIR instead of memory.
+        - --output=FILE: Write the goal's matrix to FILE as a binary dataset (see dataset.c) instead of printing it. Required by the convert
+          goal, which writes the datapoints themselves, stored as float with --precision=single.
+    Input:
+        - int argc: number of passed in user arguments.
+        - char **argv: user arguments, options start at argv[3].
+        - cli_options *options: Options to fill in, every option not given keeps its default.
+    */
+    int i;
+    char *end;
+    options->neighbours = 0;
+    options->threshold = 0.0;
+    options->landmarks = 0;
+    options->seed = 1234;
+    options->exact_exp = 0;
+    options->threads = 0;
+    options->single_precision = 0;
+    options->scratch = NULL;
+    options->output = NULL;
+    for (i = 3; i < argc; i++) {
+        if (strncmp(argv[i], "--neighbours=", 13) == 0) {
+            options->neighbours = (int)strtol(argv[i] + 13, &end, 10);
+            if (*end != '\0' || end == argv[i] + 13 || options->neighbours <= 0) break;
+        }
+        else if (strncmp(argv[i], "--threshold=", 12) == 0) {
+            options->threshold = strtod(argv[i] + 12, &end);
+            if (*end != '\0' || end == argv[i] + 12 || options->threshold <= 0.0 || options->threshold > 1.0) break;
+        }
+        else if (strncmp(argv[i], "--landmarks=", 12) == 0) {
+            options->landmarks = (int)strtol(argv[i] + 12, &end, 10);
+            if (*end != '\0' || end == argv[i] + 12 || options->landmarks <= 0) break;
+        }
+        else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            options->seed = strtoul(argv[i] + 7, &end, 10);
+            if (*end != '\0' || end == argv[i] + 7) break;
+        }
+        else if (strcmp(argv[i], "--exact-exp") == 0) {
+            options->exact_exp = 1;
+        }
+        else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            options->threads = (int)strtol(argv[i] + 10, &end, 10);
+            if (*end != '\0' || end == argv[i] + 10 || options->threads <= 0) break;
+        }
+        else if (strcmp(argv[i], "--precision=single") == 0 || strcmp(argv[i], "--precision=double") == 0) {
+            options->single_precision = (argv[i][12] == 's');
+        }
+        else if (strncmp(argv[i], "--scratch=", 10) == 0 && argv[i][10] != '\0') {
+            options->scratch = argv[i] + 10;
+        }
+        else if (strncmp(argv[i], "--output=", 9) == 0 && argv[i][9] != '\0') {
+            options->output = argv[i] + 9;
+        }
+        else {
+            break;
+        }
+    }
+    if (i < argc) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
 }
 
 
 int main(int argc, char **argv) {
     /* Main function for SymNMF in C, handles user input and calling appropriate wrapper functions.
     Input:
-        - int argc: number of passed in user arguments (must be exactly 3 in order for program to run)
-        - char **argv: user arguments (must be in the form (c_filename, goal, filepath))
+        - int argc: number of passed in user arguments (must be at least 3 in order for program to run)
+        - char **argv: user arguments (must be in the form (c_filename, goal, filepath, [options...]), see parse_options for options).
+          The file is either comma separated text or a binary dataset (see dataset.c), which is memory mapped instead of parsed.
     */
     datapoints_wrapper *datapoints;
+    cli_options options;
     
-    char *goals[] = {"sym", "ddg", "norm"};
-    if (argc != 3) {
+    char *goals[] = {"sym", "ddg", "norm", "convert"};
+    if (argc < 3) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
-    datapoints = initialize_data(argv[2]);
-    populate_data(datapoints, argv[2]);
+    parse_options(argc, argv, &options);
+    num_threads_from_environment();
+    set_num_threads(options.threads);
+    datapoints = dataset_is_binary(argv[2]) ? load_dataset(argv[2]) : read_data(argv[2]);
     
-    if (strcmp(goals[0], argv[1]) == 0) {
-        sym(datapoints);
+    if (strcmp(goals[0], argv[1]) != 0 && strcmp(goals[1], argv[1]) != 0 && strcmp(goals[2], argv[1]) != 0 && strcmp(goals[3], argv[1]) != 0) {
+        datapoints_on_error_handler(datapoints);
+        exit(EXIT_FAILURE);
     }
-    else if (strcmp(goals[1], argv[1]) == 0) {
-        ddg(datapoints);
+    if (options.output == NULL && strcmp(goals[3], argv[1]) == 0) {
+        datapoints_on_error_handler(datapoints); /* Converting only writes a file, it needs a path */
+        exit(EXIT_FAILURE);
     }
-    else if (strcmp(goals[2], argv[1]) == 0) {
-        norm(datapoints);
+    set_binary_output(options.output);
+    if ((options.neighbours > 0 || options.threshold > 0.0) && options.landmarks > 0) {
+        datapoints_on_error_handler(datapoints); /* Sparse and low rank modes are exclusive */
+        exit(EXIT_FAILURE);
     }
-    else {
-        datapoints_on_error_handler(datapoints);
+    if ((options.neighbours > 0 || options.threshold > 0.0 || options.landmarks > 0) && options.single_precision) {
+        datapoints_on_error_handler(datapoints); /* Single precision is only available for the dense matrices */
         exit(EXIT_FAILURE);
     }
-    free_matrix(datapoints->datapoints, datapoints->num_points);
-    free(datapoints);
+    if ((options.neighbours > 0 || options.threshold > 0.0 || options.landmarks > 0 || options.single_precision) && options.scratch != NULL) {
+        datapoints_on_error_handler(datapoints); /* The memory mapped matrix is dense and double precision */
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(goals[3], argv[1]) == 0) {
+        convert(datapoints, &options);
+    }
+    else if (options.neighbours > 0 || options.threshold > 0.0) {
+        sparse_goals(datapoints, &options, argv[1]);
+    }
+    else if (options.landmarks > 0) {
+        low_rank_goals(datapoints, &options, argv[1]);
+    }
+    else if (options.scratch != NULL) {
+        mapped_goals(datapoints, &options, argv[1]);
+    }
+    else if (strcmp(goals[0], argv[1]) == 0) {
+        sym(datapoints, &options);
+    }
+    else if (strcmp(goals[1], argv[1]) == 0) {
+        ddg(datapoints, &options);
+    }
+    else {
+        norm(datapoints, &options);
+    }
+    free_datapoints(datapoints);
     exit(EXIT_SUCCESS);
 }
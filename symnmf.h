@@ -1,32 +1,134 @@
 
 typedef struct datapoints_wrapper datapoints_wrapper;
 
-void free_update_H_matrices(double **w_h_mult, double **h_t, double **h_h_t_mult, double **h_h_t_h_mult);
+typedef struct cli_options cli_options;
 
-double **update_H(double **prev_H, double **W, int n, int k);
+typedef enum norm_representation {
+    dense_norm,
+    single_dense_norm,
+    sparse_norm,
+    low_rank_norm,
+    mapped_norm
+} norm_representation;
 
-double frobenius_norm_squared(double **matrix, int m, int n);
+typedef struct norm_operator {
+    norm_representation representation;
+    int n;
+    double **dense;
+    float **single_dense;
+    struct csr_matrix *sparse;
+    struct low_rank_matrix *low_rank;
+    struct mapped_matrix *mapped;
+} norm_operator;
 
-void converge_H_memory_freer(double **prev_H, double **distance_matrix);
+typedef enum solver_method {
+    multiplicative_solver,
+    anls_solver,
+    hals_solver,
+    accelerated_solver
+} solver_method;
 
-double **converge_H(double **initial_H, double **W, int n, int k);
+typedef int (*solver_callback)(int iteration, double step, double objective, double elapsed, void *context);
+
+typedef struct solver_options {
+    solver_method method;
+    double beta;
+    double epsilon;
+    int max_iter;
+    solver_callback callback;
+    void *callback_context;
+} solver_options;
+
+typedef struct solver_workspace {
+    int n;
+    int k;
+    int threads;
+    solver_options options;
+    double symmetry_penalty;
+    double damping;
+    double **H[2];
+    double **extrapolated_H;
+    double **w_h_mult;
+    double **h_t_h_mult;
+    double **h_h_t_h_mult;
+    double **projection;
+    double **partial_products;
+    double *nnls_scratch;
+    int *nnls_sets;
+    double *gemm_scratch;
+    double w_norm_squared;
+} solver_workspace;
+
+void free_solver_workspace(solver_workspace *workspace);
+
+void solver_options_defaults(solver_options *options);
+
+solver_workspace *solver_workspace_creation(norm_operator *W, int n, int k, const solver_options *options);
+
+int solver_method_from_name(const char *name);
+
+void norm_operator_multiplication(norm_operator *W, double **H, solver_workspace *workspace);
+
+double norm_operator_frobenius_squared(norm_operator *W);
+
+double norm_operator_max_row_sum(norm_operator *W);
+
+double multiplicative_step(double **prev_H, double **next_H, double **w_h_mult, double **h_h_t_h_mult, int n, int k, double damping);
+
+double multiplicative_step_f32(float **prev_H, float **next_H, float **w_h_mult, float **h_h_t_h_mult, int n, int k, double damping);
+
+double factorization_objective(double **H, double **w_h_mult, double **h_t_h_mult, int n, int k, double w_norm_squared);
+
+double factorization_objective_f32(float **H, float **w_h_mult, float **h_t_h_mult, int n, int k, double w_norm_squared);
+
+double update_H(double **prev_H, double **next_H, norm_operator *W, solver_workspace *workspace, double *objective);
+
+double update_H_alternating(double **prev_H, double **next_H, norm_operator *W, solver_workspace *workspace, double *objective);
+
+double objective_from_products(double **H, norm_operator *W, solver_workspace *workspace);
+
+double symnmf_objective(double **H, norm_operator *W, solver_workspace *workspace);
+
+double **solve_H(double **initial_H, norm_operator *W, solver_workspace *workspace, double *objective);
+
+int solver_iteration_report(solver_workspace *workspace, int iteration, double step, double objective, double start_time);
+
+double **solve_H_accelerated(double **initial_H, norm_operator *W, solver_workspace *workspace, double *objective);
+
+double **converge_H(double **initial_H, norm_operator *W, int n, int k, const solver_options *options);
+
+float **converge_H_f32(float **initial_H, float **W, int n, int k, const solver_options *options);
+
+double norm_operator_sum(norm_operator *W);
+
+double **initial_H_creation(norm_operator *W, int n, int k, unsigned long seed);
+
+double **solve_restart(norm_operator *W, int n, int k, unsigned long seed, const solver_options *options, double *objective);
+
+double **converge_H_restarts(norm_operator *W, int n, int k, int restarts, unsigned long seed, const solver_options *options, double *best_objective);
+
+double **fit_H(double **datapoints, int n, int d, int k, int precision, int exact_exp, int restarts, unsigned long seed, const solver_options *options);
+
+void free_datapoints(datapoints_wrapper *datapoints);
 
 void datapoints_on_error_handler(datapoints_wrapper *datapoints);
 
-void invalid_file_read_error_handler(FILE *file, datapoints_wrapper *wrapper, int row);
+datapoints_wrapper* read_data(const char *filename);
+
+datapoints_wrapper* load_dataset(const char *filename);
 
-void invalid_file_read_error_handler_simple_case(FILE *file, datapoints_wrapper *wrapper);
+void convert(datapoints_wrapper *datapoints, cli_options *options);
 
-datapoints_wrapper* initialize_data(const char *filename);
+void sym(datapoints_wrapper *datapoints, cli_options *options);
 
-void determine_data_dimension(FILE *file, datapoints_wrapper *wrapper);
+void ddg(datapoints_wrapper *datapoints, cli_options *options);
 
-void read_and_store_datapoints(FILE *file, datapoints_wrapper *wrapper);
+void norm(datapoints_wrapper *datapoints, cli_options *options);
 
-void populate_data(datapoints_wrapper *wrapper, const char *filename);
+void sparse_goals(datapoints_wrapper *datapoints, cli_options *options, const char *goal);
 
-void sym(datapoints_wrapper *datapoints);
+void low_rank_goals(datapoints_wrapper *datapoints, cli_options *options, const char *goal);
 
-void ddg(datapoints_wrapper *datapoints);
+void mapped_goals(datapoints_wrapper *datapoints, cli_options *options, const char *goal);
 
-void norm(datapoints_wrapper *datapoints);
\ No newline at end of file
+void parse_options(int argc, char **argv, cli_options *options);
\ No newline at end of file
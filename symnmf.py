@@ -2,38 +2,81 @@ import argparse
 import os
 import numpy as np
 import math
-from typing import List
+from typing import List, Union
 import symnmf_c
 import sys
 
+DATASET_MAGIC = b"SYMNMFDS"
+DATASET_HEADER_SIZE = 64
 
-def pretty_print(matrix: List[List[float]]):
-    """Function to print matrices as per project specifications 
+
+def as_matrix(matrix: Union[np.ndarray, List[List[float]]]) -> np.ndarray:
+    """Function to view a matrix as the C contiguous float64 array the C module reads in place, copying it only if it isn't one already
 
     Args:
-        matrix (List[List[float]]): Matrix we want to print.
+        matrix (Union[np.ndarray, List[List[float]]]): Matrix (array, list of lists or buffer returned by the C module).
+
+    Returns:
+        np.ndarray: The matrix as a C contiguous float64 array.
     """
+    return np.ascontiguousarray(matrix, dtype=np.float64)
+
+
+def pretty_print(matrix: Union[np.ndarray, List[List[float]]]):
+    """Function to print matrices as per project specifications, through the C writer's buffered formatter when printing to the real
+    stdout (the C writer can't see a redirected sys.stdout).
+
+    Args:
+        matrix (Union[np.ndarray, List[List[float]]]): Matrix we want to print.
+    """
+    if sys.stdout is sys.__stdout__:
+        sys.stdout.flush()
+        symnmf_c.write(matrix)
+        return
     for i in range(len(matrix)):
         print(",".join(map(lambda x:  f'{x:.4f}', matrix[i])))
 
 
-def initialize_H(norm_matrix: List[List[float]], K: int) -> List[List[float]]:
+def write(matrix: Union[np.ndarray, List[List[float]]], output: str = ""):
+    """Prints a matrix, or writes it to a file as a binary dataset (see read_dataset) if a path is given.
+
+    Args:
+        matrix (Union[np.ndarray, List[List[float]]]): Matrix we want to write.
+        output (str): Path of the binary dataset, prints the matrix if empty.
+    """
+    if output:
+        symnmf_c.write(matrix, output)
+    else:
+        pretty_print(matrix)
+
+
+def initialize_H(norm_matrix: np.ndarray, K: int) -> np.ndarray:
     """Creates initial H matrix as per project specifications, uses np random seed 1234.
 
     Args:
-        norm_matrix (List[List[float]]): Previously calculated norm matrix
+        norm_matrix (np.ndarray): Previously calculated norm matrix
+        K (int): Number of clusters.
+
+    Returns:
+        np.ndarray: Resultant initialized H matrix
+    """
+    return initialize_H_from_mean(np.mean(norm_matrix), len(norm_matrix), K)
+
+
+def initialize_H_from_mean(m: float, dimension: int, K: int) -> np.ndarray:
+    """Creates initial H matrix as per project specifications given only the mean of the norm matrix, uses np random seed 1234.
+
+    Args:
+        m (float): Mean of all entries of the norm matrix
+        dimension (int): Size of the norm matrix, number of rows in H.
         K (int): Number of clusters.
 
     Returns:
-        List[List[float]]: Resultant initialized H matrix
+        np.ndarray: Resultant initialized H matrix
     """
     np.random.seed(1234)
-    m = np.mean(norm_matrix)
-    dimension = len(norm_matrix)
-    H = []
     upper_bound = 2 * np.sqrt(m / K)
-    H = np.random.uniform(0, upper_bound, size=(dimension, K))
-    return H.tolist()
+    return np.random.uniform(0, upper_bound, size=(dimension, K))
     
 
 def parse() -> argparse.Namespace:
@@ -45,76 +88,141 @@ def parse() -> argparse.Namespace:
     parser.add_argument('K', type=str)
     parser.add_argument('goal', type=str)
     parser.add_argument('file_name', type=str)
+    parser.add_argument('--neighbours', type=int, default=0, help="symnmf only: keep each point's N nearest neighbours (sparse mode)")
+    parser.add_argument('--threshold', type=float, default=0.0, help="symnmf only: keep similarities of at least T, among the N nearest neighbours if --neighbours is given (sparse mode)")
+    parser.add_argument('--landmarks', type=int, default=0, help="symnmf only: approximate the norm matrix from M landmarks (Nystrom mode)")
+    parser.add_argument('--threads', type=int, default=0, help="number of threads used by the C kernels, 0 keeps SYMNMF_NUM_THREADS / OMP_NUM_THREADS")
+    parser.add_argument('--solver', type=str, default="mu", help="symnmf only: mu (multiplicative updates), anls, hals or amu (accelerated multiplicative updates)")
+    parser.add_argument('--beta', type=float, default=0.5, help="symnmf only: damping of the multiplicative updates, in (0, 1]")
+    parser.add_argument('--epsilon', type=float, default=1e-4, help="symnmf only: stop once ||H_t+1 - H_t||_F^2 falls below this")
+    parser.add_argument('--max-iter', type=int, default=300, help="symnmf only: maximum number of iterations")
+    parser.add_argument('--precision', type=str, default="double", help="double, single to calculate the dense matrices and solve in float (symnmf only with the mu solver and one restart), or mixed (symnmf only) to solve with a float norm matrix")
+    parser.add_argument('--restarts', type=int, default=1, help="symnmf only: run R randomly initialized solves, split between the threads, and keep the lowest objective one")
+    parser.add_argument('--output', type=str, default="", help="write the resulting matrix to this file as a binary dataset instead of printing it")
+    parser.add_argument('--scratch', type=str, default="", help="symnmf only: keep the norm matrix in a memory mapped file in this directory instead of memory")
+
+    parser.error = parse_error
+    args, unknown = parser.parse_known_args()
+    if unknown:
+        parse_error("unrecognized arguments")
+    return args
+
+
+def parse_error(message: str) -> None:
+    """Reports invalid command line arguments (a wrong number of positionals, an unknown option or an invalid option value) as per project specifications
+    Args:
+        message (str): argparse's description of the problem, not printed
+    """
+    print("An Error Has Occurred")
+    exit(1)
 
-    if len(sys.argv) != 4:
+
+def read_dataset(filepath: str) -> Union[np.ndarray, None]:
+    """Function to map a binary dataset (written by the C program's convert goal) without parsing it
+    Args:
+        filepath (str): filepath to a file that may be a binary dataset
+    Returns:
+        np.ndarray: Read only n x d array mapped from the file, None if the file is not a binary dataset.
+    """
+    with open(filepath, "rb") as file:
+        header = file.read(DATASET_HEADER_SIZE)
+    if len(header) < DATASET_HEADER_SIZE or not header.startswith(DATASET_MAGIC):
+        return None
+    n, d, element_size = np.frombuffer(header, dtype="<u8", count=3, offset=len(DATASET_MAGIC))
+    if n == 0 or d == 0 or element_size not in (4, 8):
+        print("An Error Has Occurred")
+        exit(1)
+    try:
+        return np.memmap(filepath, dtype="<f8" if element_size == 8 else "<f4", mode="r", offset=DATASET_HEADER_SIZE, shape=(int(n), int(d)))
+    except ValueError:
         print("An Error Has Occurred")
         exit(1)
-
-    return parser.parse_args()
 
 
-def read_file(filepath: str) -> List[List[float]]:
-    """Function to read datapoints from file
+def read_file(filepath: str) -> np.ndarray:
+    """Function to read datapoints from file, parsed in C (a binary dataset is mapped instead, without a copy when it holds doubles)
     Args:
-        filepath (str): filepath to .txt file containing valid datapoints
+        filepath (str): filepath to .txt file containing valid datapoints, or to a binary dataset
     Returns:
-        List[List[float]]: 2D Array, each element is a datapoint which is itself an array of floats.
+        np.ndarray: n x d array, each row is a datapoint.
     """
-    points = []
-    with open(filepath, "r", encoding="utf-8") as file:
-        for line in file:
-            line = line.strip()
-            point = line.split(",")
-            try:
-                point = list(map(float, point))
-            except ValueError:
-                print("An Error Has Occurred")
-                exit(1)
-            points.append(point)
-    return points
-
-
-def sym(points: List[List[float]]) -> List[List[float]]:
+    points = read_dataset(filepath)
+    if points is None:
+        points = symnmf_c.read_file(filepath, buffer=True)
+    return as_matrix(points)
+
+
+def sym(points: Union[np.ndarray, List[List[float]]], precision: str = "double") -> np.ndarray:
     """Python wrapper function to calculate similarity matrix by calling appropriate C module function.
     Args:
-        points (List[List[float]]): Datapoints used to calculate similarity matrix
+        points (Union[np.ndarray, List[List[float]]]): Datapoints used to calculate similarity matrix
+        precision (str): "double", or "single" to calculate the matrices in C as float
     Returns:
-        List[List[float]]: Resultant similarity matrix
+        np.ndarray: Resultant similarity matrix
     """
-    return symnmf_c.sym(points)
+    return np.asarray(symnmf_c.sym(as_matrix(points), precision=precision))
 
 
-def diag(points: List[List[float]]) -> List[List[float]]:
+def diag(points: Union[np.ndarray, List[List[float]]], precision: str = "double") -> np.ndarray:
     """Python wrapper function to calculate diagonal matrix by calling appropriate C module function.
     Args:
-        points (List[List[float]]): Datapoints used to calculate diagonal matrix
+        points (Union[np.ndarray, List[List[float]]]): Datapoints used to calculate diagonal matrix
+        precision (str): "double" or "single", the degrees are summed in double precision either way
     Returns:
-        List[List[float]]: Resultant diagonal matrix
+        np.ndarray: Resultant diagonal matrix
     """
-    return symnmf_c.diag(points)
+    return np.asarray(symnmf_c.diag(as_matrix(points), precision=precision))
 
 
-def norm(points: List[List[float]]) -> List[List[float]]:
+def norm(points: Union[np.ndarray, List[List[float]]], precision: str = "double") -> np.ndarray:
     """Python wrapper function to calculate norm matrix by calling appropriate C module function.
     Args:
-        points (List[List[float]]): Datapoints used to calculate norm matrix
+        points (Union[np.ndarray, List[List[float]]]): Datapoints used to calculate norm matrix
+        precision (str): "double", or "single" to calculate the matrices in C as float
     Returns:
-        List[List[float]]: Resultant norm matrix
+        np.ndarray: Resultant norm matrix
     """
-    return symnmf_c.norm(points)
+    return np.asarray(symnmf_c.norm(as_matrix(points), precision=precision))
 
 
-def nmf(K: int, points: List[List[float]]) -> List[List[float]]:
+def nmf(K: int, points: Union[np.ndarray, List[List[float]]], neighbours: int = 0, threshold: float = 0.0, landmarks: int = 0, restarts: int = 1, solver: str = "mu", precision: str = "double", scratch: str = "", **solver_options) -> np.ndarray:
     """Python wrapper function to calculate symnmf matrix by calling appropriate C module function.
     Args:
         K (int): number of clusters
-        points (List[List[float]]): Datapoints used to calculate symnmf matrix
+        points (Union[np.ndarray, List[List[float]]]): Datapoints used to calculate symnmf matrix
+        neighbours (int): If positive, the norm matrix is sparse and keeps only each point's nearest neighbours
+        threshold (float): If positive, the norm matrix is sparse and keeps only similarities of at least threshold (among the nearest neighbours when both are given)
+        landmarks (int): If positive, the norm matrix is never built and is approximated from this many landmark points instead
+        restarts (int): If above 1, H is initialized in C from seeds 1234, 1235, ... and the lowest objective solve is returned
+        solver (str): Update rule, "mu" (damped multiplicative updates), "anls" (alternating nonnegative least squares), "hals" (hierarchical ALS) or "amu" (accelerated multiplicative updates)
+        precision (str): "double", "single" to calculate the dense norm matrix and solve in C as float (only with restarts of 1 and the "mu" solver),
+            or "mixed" to store the dense norm matrix as float while H and every reduction of the solver stay double
+        scratch (str): If given, the dense norm matrix is calculated in C into a memory mapped file in this directory instead of memory and
+            streamed from it every iteration, H is then initialized in C (the same draws as initialize_H)
+        Otherwise the dense norm matrix is calculated, H initialized from it (the same draws as initialize_H) and solved entirely in C, see
+        symnmf_c.fit, only H comes back to Python.
+        solver_options: beta, epsilon, max_iter and callback, passed on to the C solver. callback(iteration, step, objective, elapsed) is
+            called after every iteration, returning True from it stops the solve early.
     Returns:
-        List[List[float]]: Resultant symnmf matrix
+        np.ndarray: Resultant symnmf matrix
     """
-    norm_matrix = norm(points)
-    H = initialize_H(norm_matrix, K)
-    return symnmf_c.symnmf(H, norm_matrix)
+    points = as_matrix(points)
+    if neighbours > 0 or threshold > 0.0:
+        sparse_norm_matrix = symnmf_c.sparse_norm(points, neighbours=neighbours, threshold=threshold)
+        if restarts > 1:
+            return np.asarray(symnmf_c.sparse_symnmf(K, sparse_norm_matrix, restarts=restarts, seed=1234, solver=solver, **solver_options))
+        H = initialize_H_from_mean(sum(sparse_norm_matrix[0]) / (len(points) ** 2), len(points), K)
+        return np.asarray(symnmf_c.sparse_symnmf(H, sparse_norm_matrix, solver=solver, **solver_options))
+    if landmarks > 0:
+        factor, shift = symnmf_c.nystrom_norm(points, landmarks)
+        if restarts > 1:
+            return np.asarray(symnmf_c.low_rank_symnmf(K, (factor, shift), restarts=restarts, seed=1234, solver=solver, **solver_options))
+        column_sums = np.sum(np.asarray(factor), axis=0)
+        H = initialize_H_from_mean((np.dot(column_sums, column_sums) - sum(shift)) / (len(points) ** 2), len(points), K)
+        return np.asarray(symnmf_c.low_rank_symnmf(H, (factor, shift), solver=solver, **solver_options))
+    if scratch:
+        return np.asarray(symnmf_c.mapped_symnmf(K, points, scratch, restarts=restarts, seed=1234, solver=solver, **solver_options))
+    return np.asarray(symnmf_c.fit(points, K, 1234, restarts=restarts, solver=solver, precision=precision, **solver_options))
 
 
 def main():
@@ -125,6 +233,14 @@ def main():
     K, goal, file_name = args.K, args.goal, args.file_name
     filepath = os.path.join(os.path.join(os.getcwd()), file_name)
     points = read_file(filepath)
+    if args.threads < 0:
+        print("An Error Has Occurred")
+        return
+    if args.threads > 0:
+        symnmf_c.set_num_threads(args.threads)
+    if args.precision not in ("double", "single", "mixed"):
+        print("An Error Has Occurred")
+        return
 
     goals_mapping = {"symnmf": 0, "sym": 1, "ddg": 2, "norm": 3}
     if goal not in goals_mapping:
@@ -142,16 +258,32 @@ def main():
             print("An Error Has Occurred")
             return
         
-        if K <= 1 or K >= len(points):
+        if K <= 1 or K >= len(points) or args.neighbours < 0 or not 0.0 <= args.threshold <= 1.0 or args.landmarks < 0 or args.restarts < 1 or args.solver not in ("mu", "anls", "hals", "amu"):
+            print("An Error Has Occurred")
+            return
+        if not 0.0 < args.beta <= 1.0 or args.epsilon < 0.0 or args.max_iter < 1:
+            print("An Error Has Occurred")
+            return
+        if (args.neighbours > 0 or args.threshold > 0.0) and args.landmarks > 0:
+            print("An Error Has Occurred")
+            return
+        if args.precision == "single" and (args.restarts > 1 or args.solver != "mu"):
+            print("An Error Has Occurred")
+            return
+        if args.precision != "double" and (args.neighbours > 0 or args.threshold > 0.0 or args.landmarks > 0):
+            print("An Error Has Occurred")
+            return
+        if args.scratch and (args.precision != "double" or args.neighbours > 0 or args.threshold > 0.0 or args.landmarks > 0):
             print("An Error Has Occurred")
             return
-        pretty_print(nmf(K, points))
+        write(nmf(K, points, args.neighbours, args.threshold, args.landmarks, args.restarts, args.solver, args.precision, args.scratch,
+                  beta=args.beta, epsilon=args.epsilon, max_iter=args.max_iter), args.output)
     elif goals_mapping[goal] == 1:
-        pretty_print(sym(points))
+        write(sym(points, "single" if args.precision == "single" else "double"), args.output)
     elif goals_mapping[goal] == 2:
-        pretty_print(diag(points))
+        write(diag(points, "single" if args.precision == "single" else "double"), args.output)
     elif goals_mapping[goal] == 3:
-        pretty_print(norm(points))
+        write(norm(points, "single" if args.precision == "single" else "double"), args.output)
 
 
 
@@ -0,0 +1,68 @@
+/* Type generic source of the elementwise parts of symnmf.c's damped multiplicative update, included once per precision. The includer defines
+   real (the element type of H and of the products) and precision_function(name) (the name of a function's instantiation), both are
+   undefined again at the end. */
+
+
+double precision_function(multiplicative_step)(real **prev_H, real **next_H, real **w_h_mult, real **h_h_t_h_mult, int n, int k, double damping) {
+    /* Writes the next iteration of H from the previous one and its products, next_H = prev_H * (1 - beta + beta * (W * H) / (H * H^T * H))
+       entrywise, while summing the squared change of every entry (the convergence distance) in double precision.
+    Input: 
+        - real prev_H[][]: Previous nxk iteration of H.
+        - real next_H[][]: nxk matrix the next iteration of H is written to, must not be prev_H.
+        - real w_h_mult[][]: nxk W * prev_H.
+        - real h_h_t_h_mult[][]: nxk prev_H * prev_H^T * prev_H.
+        - int n: Number of rows in H.
+        - int k: Number of columns in H.
+        - double damping: The step's beta.
+    Returns:
+        ||next_H - prev_H||_F^2
+    */
+    int i, j;
+    double difference, distance_squared = 0.0;
+#ifdef _OPENMP
+    #pragma omp parallel for private(j, difference) reduction(+:distance_squared) schedule(static) num_threads(num_threads())
+#endif
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < k; j++) {
+            next_H[i][j] = prev_H[i][j] * (1 - damping + damping*(w_h_mult[i][j]/h_h_t_h_mult[i][j]));
+            difference = next_H[i][j] - prev_H[i][j];
+            distance_squared += difference * difference;
+        }
+    }
+    return distance_squared;
+}
+
+
+double precision_function(factorization_objective)(real **H, real **w_h_mult, real **h_t_h_mult, int n, int k, double w_norm_squared) {
+    /* Calculates ||W - H * H^T||_F^2 = ||W||_F^2 - 2 * tr(H^T * W * H) + ||H^T * H||_F^2 from W * H and H^T * H, summed in double precision.
+    Input: 
+        - real H[][]: nxk matrix the products were calculated from.
+        - real w_h_mult[][]: nxk W * H.
+        - real h_t_h_mult[][]: kxk triangular H^T * H.
+        - int n: Number of rows in H.
+        - int k: Number of columns in H.
+        - double w_norm_squared: ||W||_F^2.
+    Returns:
+        The objective.
+    */
+    int i, j;
+    double trace = 0.0, gram_squared = 0.0;
+#ifdef _OPENMP
+    #pragma omp parallel for private(j) reduction(+:trace) schedule(static) num_threads(num_threads())
+#endif
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < k; j++) {
+            trace += (double)H[i][j] * w_h_mult[i][j];
+        }
+    }
+    for (i = 0; i < k; i++) {
+        gram_squared += (double)h_t_h_mult[i][i] * h_t_h_mult[i][i];
+        for (j = i + 1; j < k; j++) {
+            gram_squared += 2.0 * h_t_h_mult[i][j] * h_t_h_mult[i][j];
+        }
+    }
+    return w_norm_squared - 2.0 * trace + gram_squared;
+}
+
+#undef real
+#undef precision_function
@@ -5,14 +5,33 @@
 #include "sym.h"
 #include "diagonal.h"
 #include "norm.h"
+#include "sparse.h"
+#include "nystrom.h"
+#include "parallel.h"
+#include "mapped.h"
+#include "dataset.h"
+#include "reader.h"
+#include "writer.h"
 #include "symnmf.h"
 
 typedef struct c_matrix_wrapper {
     double **matrix;
     Py_ssize_t rows;
     Py_ssize_t cols;
+    int buffered;
+    Py_buffer view;
+    double *copy;
 } c_matrix_wrapper;
 
+typedef struct py_matrix_object {
+    PyObject_HEAD
+    double **matrix;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+} py_matrix_object;
+
+static PyObject *py_matrix_type = NULL;
+
 
 void py_matrix_to_c_matrix_error_handler(c_matrix_wrapper *wrapper, int cur_num_rows) {
     /* Function to handle deallocating memory in case of error. 
@@ -27,8 +46,105 @@ void py_matrix_to_c_matrix_error_handler(c_matrix_wrapper *wrapper, int cur_num_
 }
 
 
+int py_is_buffer_matrix(PyObject *matrix_py_ptr) {
+    /* Tells whether a wrapper's matrix argument is given as a buffer (a NumPy array, memoryview or Matrix) rather than a list of lists,
+       wrappers return their matrices as buffers (see c_matrix_to_py_buffer) exactly when they are given one.
+    Input: 
+        - PyObject *matrix_py_ptr: The argument.
+    */
+    return !PyList_Check(matrix_py_ptr) && PyObject_CheckBuffer(matrix_py_ptr);
+}
+
+
+int py_buffer_is_double(const char *format) {
+    /* Tells whether a buffer's struct module format describes native doubles (a NULL format means unsigned bytes).
+    Input: 
+        - const char *format: The buffer's format.
+    */
+    const int one = 1;
+    if (format == NULL) return 0;
+    if (*format == '@' || *format == '=' || (*format == '<' && *(const char *)&one == 1)) format++;
+    return strcmp(format, "d") == 0;
+}
+
+
+c_matrix_wrapper *py_buffer_to_c_matrix(PyObject *matrix_py_ptr) {
+    /* Converts a 2 dimensional float64 buffer (e.g. a NumPy array) to c matrix without copying it: the rows point straight into the
+       buffer, which stays acquired until the wrapper is freed. Buffers whose rows aren't C contiguous are copied into one block first.
+       The matrix is only read. Returns NULL on error.
+    Input: 
+        - PyObject *matrix_py_ptr: Python object exporting the buffer.
+    Returns:
+        Wrapper for c matrix, includes matrix itself as well as matrix dimensions. */
+    Py_ssize_t i;
+    double *data;
+    c_matrix_wrapper *wrapper;
+    wrapper = malloc(sizeof(c_matrix_wrapper));
+    if (wrapper == NULL) {return NULL;}
+    if (PyObject_GetBuffer(matrix_py_ptr, &wrapper->view, PyBUF_RECORDS_RO) != 0) {
+        PyErr_Clear();
+        free(wrapper);
+        return NULL;
+    }
+    wrapper->buffered = 1;
+    wrapper->copy = NULL;
+    wrapper->matrix = NULL;
+    if (wrapper->view.ndim != 2 || wrapper->view.itemsize != sizeof(double) || !py_buffer_is_double(wrapper->view.format) ||
+        wrapper->view.shape[0] <= 0 || wrapper->view.shape[1] <= 0) {
+        PyBuffer_Release(&wrapper->view);
+        free(wrapper);
+        return NULL;
+    }
+    wrapper->rows = wrapper->view.shape[0];
+    wrapper->cols = wrapper->view.shape[1];
+    data = wrapper->view.buf;
+    if (!PyBuffer_IsContiguous(&wrapper->view, 'C')) {
+        wrapper->copy = malloc(wrapper->view.len);
+        if (wrapper->copy == NULL || PyBuffer_ToContiguous(wrapper->copy, &wrapper->view, wrapper->view.len, 'C') != 0) {
+            PyErr_Clear();
+            free(wrapper->copy);
+            PyBuffer_Release(&wrapper->view);
+            free(wrapper);
+            return NULL;
+        }
+        data = wrapper->copy;
+    }
+    wrapper->matrix = malloc(wrapper->rows * sizeof(double *));
+    if (wrapper->matrix == NULL) {
+        free(wrapper->copy);
+        PyBuffer_Release(&wrapper->view);
+        free(wrapper);
+        return NULL;
+    }
+    for (i = 0; i < wrapper->rows; i++) {
+        wrapper->matrix[i] = data + i * wrapper->cols;
+    }
+    return wrapper;
+}
+
+
+void free_c_matrix_wrapper(c_matrix_wrapper *wrapper) {
+    /* Frees a c matrix wrapper made by py_matrix_to_c_matrix, releasing its buffer if it was made from one.
+    Input: 
+        - c_matrix_wrapper *wrapper: Wrapper we are freeing, can be NULL.
+    */
+    if (wrapper == NULL) {
+        return;
+    }
+    if (wrapper->buffered) {
+        free(wrapper->matrix);
+        free(wrapper->copy);
+        PyBuffer_Release(&wrapper->view);
+    }
+    else {
+        free_matrix(wrapper->matrix, wrapper->rows);
+    }
+    free(wrapper);
+}
+
+
 c_matrix_wrapper *py_matrix_to_c_matrix(PyObject *matrix_py_ptr) {
-    /* Converts python matrix to c matrix. Returns NULL on error.
+    /* Converts python matrix, a list of lists or a float64 buffer (see py_buffer_to_c_matrix), to c matrix. Returns NULL on error.
     Input: 
         - PyObject *matrix_py_ptr: Python matrix we want to convert to c matrix
     Returns:
@@ -36,121 +152,1099 @@ c_matrix_wrapper *py_matrix_to_c_matrix(PyObject *matrix_py_ptr) {
     PyObject *temp_row_py_ptr, *coord_py_ptr;
     Py_ssize_t i, j;
     c_matrix_wrapper *wrapper;
+    if (!PyList_Check(matrix_py_ptr)) {
+        return py_buffer_to_c_matrix(matrix_py_ptr);
+    }
     wrapper = malloc(sizeof(c_matrix_wrapper));
     if (wrapper == NULL) {return NULL;}
+    wrapper->buffered = 0;
+    wrapper->copy = NULL;
     wrapper->rows = PyList_Size(matrix_py_ptr);
     wrapper->matrix = (double**)calloc(wrapper->rows, sizeof(double*));
     if (wrapper->matrix == NULL) {
         py_matrix_to_c_matrix_error_handler(wrapper, 0);
         return NULL;
     }
-    for (i = 0; i < wrapper->rows; i++) {
-        temp_row_py_ptr = PyList_GetItem(matrix_py_ptr, i);
-        if (!PyList_Check(temp_row_py_ptr)) {
-            py_matrix_to_c_matrix_error_handler(wrapper, i);
-            return NULL;
-        }
-        wrapper->cols = PyList_Size(temp_row_py_ptr);
-        wrapper->matrix[i] = (double*)calloc(wrapper->cols, sizeof(double));
-        if (wrapper->matrix[i] == NULL) {
-            py_matrix_to_c_matrix_error_handler(wrapper, i);
-            return NULL;
-        }
-        for (j = 0; j < wrapper->cols; j++) {
-            coord_py_ptr = PyList_GetItem(temp_row_py_ptr, j);
-            if (Py_IS_TYPE(coord_py_ptr, &PyFloat_Type) == 0) {
-                py_matrix_to_c_matrix_error_handler(wrapper, i);
-                return NULL;
+    for (i = 0; i < wrapper->rows; i++) {
+        temp_row_py_ptr = PyList_GetItem(matrix_py_ptr, i);
+        if (!PyList_Check(temp_row_py_ptr)) {
+            py_matrix_to_c_matrix_error_handler(wrapper, i);
+            return NULL;
+        }
+        wrapper->cols = PyList_Size(temp_row_py_ptr);
+        wrapper->matrix[i] = (double*)calloc(wrapper->cols, sizeof(double));
+        if (wrapper->matrix[i] == NULL) {
+            py_matrix_to_c_matrix_error_handler(wrapper, i);
+            return NULL;
+        }
+        for (j = 0; j < wrapper->cols; j++) {
+            coord_py_ptr = PyList_GetItem(temp_row_py_ptr, j);
+            if (Py_IS_TYPE(coord_py_ptr, &PyFloat_Type) == 0) {
+                py_matrix_to_c_matrix_error_handler(wrapper, i);
+                return NULL;
+            }
+            wrapper->matrix[i][j] = PyFloat_AsDouble(coord_py_ptr);
+        }
+    }
+    return wrapper;
+}
+
+
+double **py_symmetric_matrix_to_c_matrix(PyObject *matrix_py_ptr) {
+    /* Converts python symmetric matrix to c triangular matrix, only entries on or above the diagonal are read. Returns NULL on error.
+    Input: 
+        - PyObject *matrix_py_ptr: Python nxn symmetric matrix we want to convert to c matrix
+    Returns:
+        Triangular c matrix (see triangular_matrix_creation). */
+    PyObject *temp_row_py_ptr, *coord_py_ptr;
+    Py_ssize_t i, j, n;
+    double **matrix;
+    n = PyList_Size(matrix_py_ptr);
+    matrix = triangular_matrix_creation(n);
+    if (matrix == NULL) {return NULL;}
+    for (i = 0; i < n; i++) {
+        temp_row_py_ptr = PyList_GetItem(matrix_py_ptr, i);
+        if (!PyList_Check(temp_row_py_ptr) || PyList_Size(temp_row_py_ptr) != n) {
+            free_continuous_matrix(matrix);
+            return NULL;
+        }
+        for (j = i; j < n; j++) {
+            coord_py_ptr = PyList_GetItem(temp_row_py_ptr, j);
+            if (Py_IS_TYPE(coord_py_ptr, &PyFloat_Type) == 0) {
+                free_continuous_matrix(matrix);
+                return NULL;
+            }
+            matrix[i][j] = PyFloat_AsDouble(coord_py_ptr);
+        }
+    }
+    return matrix;
+}
+
+
+PyObject *c_matrix_to_py_matrix(double **matrix, Py_ssize_t m, Py_ssize_t n) {
+    /* Converts c matrix to python matrix
+    Input: 
+        - double **matrix: C matrix we want to convert to Python matrix
+        - Py_ssize_t m: Number of rows in matrix
+        - Py_ssize_t n: Number of columns in matrix
+    Returns:
+        Created python matrix equivalent of given C matrix.
+    */
+    PyObject *matrix_py, *temp_matrix_row_py, *matrix_entry_py;
+    Py_ssize_t i, j;
+    matrix_py = PyList_New(m);
+    for (i = 0; i < m; i++) {
+        temp_matrix_row_py = PyList_New(n);
+        PyList_SetItem(matrix_py, i, temp_matrix_row_py);
+        for (j = 0; j < n; j++) {
+            matrix_entry_py = PyFloat_FromDouble(matrix[i][j]);
+            PyList_SetItem(temp_matrix_row_py, j, matrix_entry_py);
+        }
+    }
+    return matrix_py;
+}
+
+
+PyObject *c_symmetric_matrix_to_py_matrix(double **symmetric_matrix, Py_ssize_t n) {
+    /* Converts c triangular matrix to full python matrix
+    Input: 
+        - double **symmetric_matrix: C triangular matrix we want to convert to Python matrix
+        - Py_ssize_t n: Number of rows and columns in matrix
+    Returns:
+        Created python matrix equivalent of given C matrix.
+    */
+    PyObject *matrix_py, *temp_matrix_row_py, *matrix_entry_py;
+    Py_ssize_t i, j;
+    matrix_py = PyList_New(n);
+    for (i = 0; i < n; i++) {
+        temp_matrix_row_py = PyList_New(n);
+        PyList_SetItem(matrix_py, i, temp_matrix_row_py);
+        for (j = 0; j < n; j++) {
+            matrix_entry_py = PyFloat_FromDouble(symmetric_entry(symmetric_matrix, i, j));
+            PyList_SetItem(temp_matrix_row_py, j, matrix_entry_py);
+        }
+    }
+    return matrix_py;
+}
+
+
+PyObject *c_diagonal_matrix_to_py_matrix(double *diagonal, Py_ssize_t n) {
+    /* Converts c diagonal matrix given by its diagonal alone to full python matrix
+    Input: 
+        - double *diagonal: Diagonal of the C matrix we want to convert to Python matrix
+        - Py_ssize_t n: Number of rows and columns in matrix
+    Returns:
+        Created python matrix equivalent of given C matrix.
+    */
+    PyObject *matrix_py, *temp_matrix_row_py, *matrix_entry_py;
+    Py_ssize_t i, j;
+    matrix_py = PyList_New(n);
+    for (i = 0; i < n; i++) {
+        temp_matrix_row_py = PyList_New(n);
+        PyList_SetItem(matrix_py, i, temp_matrix_row_py);
+        for (j = 0; j < n; j++) {
+            matrix_entry_py = PyFloat_FromDouble((i == j) ? diagonal[i] : 0.0);
+            PyList_SetItem(temp_matrix_row_py, j, matrix_entry_py);
+        }
+    }
+    return matrix_py;
+}
+
+
+void py_matrix_dealloc(PyObject *self) {
+    /* Frees a Matrix object along with the c matrix it owns.
+    Input: 
+        - PyObject *self: The Matrix.
+    */
+    PyTypeObject *type = Py_TYPE(self);
+    free_continuous_matrix(((py_matrix_object *)self)->matrix);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+
+int py_matrix_get_buffer(PyObject *self, Py_buffer *view, int flags) {
+    /* Exports a Matrix's c matrix as a writable C contiguous 2 dimensional float64 buffer, so np.asarray wraps it without copying. The
+       buffer keeps the Matrix (and so the c matrix) alive.
+    Input: 
+        - PyObject *self: The Matrix.
+        - Py_buffer *view: Filled with the buffer.
+        - int flags: What the consumer asked for, every request but a Fortran contiguous one can be met. A matrix with a single row or
+          column is Fortran contiguous as well and meets that one too.
+    Returns:
+        0, or -1 with a BufferError set when a Fortran contiguous buffer is asked for.
+    */
+    py_matrix_object *matrix = (py_matrix_object *)self;
+    if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && matrix->shape[0] > 1 && matrix->shape[1] > 1) {
+        view->obj = NULL;
+        PyErr_SetString(PyExc_BufferError, "Matrix is C contiguous, not Fortran contiguous");
+        return -1;
+    }
+    view->buf = matrix->matrix[0];
+    view->obj = self;
+    Py_INCREF(self);
+    view->len = matrix->shape[0] * matrix->shape[1] * (Py_ssize_t)sizeof(double);
+    view->readonly = 0;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? "d" : NULL;
+    view->ndim = (flags & PyBUF_ND) ? 2 : 1;
+    view->shape = (flags & PyBUF_ND) ? matrix->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? matrix->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+
+Py_ssize_t py_matrix_length(PyObject *self) {
+    /* len() of a Matrix, its number of rows like a list of lists or a NumPy array.
+    Input: 
+        - PyObject *self: The Matrix.
+    */
+    return ((py_matrix_object *)self)->shape[0];
+}
+
+
+static PyType_Slot py_matrix_slots[] = {
+    {Py_sq_length, (void *)py_matrix_length},
+    {Py_tp_dealloc, (void *)py_matrix_dealloc},
+    {Py_bf_getbuffer, (void *)py_matrix_get_buffer},
+    {Py_tp_doc, (void *)"C owned float64 matrix returned by the C module, exported through the buffer protocol (np.asarray wraps it without copying)"},
+    {0, NULL}
+};
+
+
+static PyType_Spec py_matrix_spec = {
+    "symnmf_c.Matrix",
+    sizeof(py_matrix_object),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    py_matrix_slots
+};
+
+
+PyObject *c_matrix_to_py_buffer(double **matrix, Py_ssize_t m, Py_ssize_t n) {
+    /* Converts c continuous matrix to a Matrix, a buffer owning the c matrix, in place of a list of n*m Python floats. Returns NULL on
+       error, the matrix is freed either way.
+    Input: 
+        - double **matrix: C continuous matrix we want to hand to Python, can be NULL (an error).
+        - Py_ssize_t m: Number of rows in matrix
+        - Py_ssize_t n: Number of columns in matrix
+    Returns:
+        Created Matrix.
+    */
+    py_matrix_object *matrix_py;
+    if (matrix == NULL) {
+        return NULL;
+    }
+    matrix_py = PyObject_New(py_matrix_object, (PyTypeObject *)py_matrix_type);
+    if (matrix_py == NULL) {
+        free_continuous_matrix(matrix);
+        return NULL;
+    }
+    matrix_py->matrix = matrix;
+    matrix_py->shape[0] = m;
+    matrix_py->shape[1] = n;
+    matrix_py->strides[0] = n * (Py_ssize_t)sizeof(double);
+    matrix_py->strides[1] = sizeof(double);
+    return (PyObject *)matrix_py;
+}
+
+
+double **copy_c_matrix(double **matrix, Py_ssize_t m, Py_ssize_t n) {
+    /* Copies any c matrix (row pointers of any layout) to a new continuous matrix. Returns NULL on error.
+    Input: 
+        - double **matrix: C matrix we want to copy.
+        - Py_ssize_t m: Number of rows in matrix
+        - Py_ssize_t n: Number of columns in matrix
+    Returns:
+        Continuous mxn copy.
+    */
+    Py_ssize_t i;
+    double **copy = continuous_matrix_creation(m, n);
+    for (i = 0; copy != NULL && i < m; i++) {
+        memcpy(copy[i], matrix[i], n * sizeof(double));
+    }
+    return copy;
+}
+
+
+PyObject *c_symmetric_matrix_to_py_buffer(double **symmetric_matrix, Py_ssize_t n) {
+    /* Converts c triangular matrix to a full nxn Matrix (see c_matrix_to_py_buffer), expanded without holding the GIL. Returns NULL on error.
+    Input: 
+        - double **symmetric_matrix: C triangular matrix we want to convert.
+        - Py_ssize_t n: Number of rows and columns in matrix
+    Returns:
+        Created Matrix.
+    */
+    Py_ssize_t i, j;
+    double **matrix;
+    Py_BEGIN_ALLOW_THREADS
+    matrix = continuous_matrix_creation(n, n);
+    for (i = 0; matrix != NULL && i < n; i++) {
+        for (j = i; j < n; j++) {
+            matrix[i][j] = matrix[j][i] = symmetric_matrix[i][j];
+        }
+    }
+    Py_END_ALLOW_THREADS
+    return c_matrix_to_py_buffer(matrix, n, n);
+}
+
+
+PyObject *c_symmetric_matrix_f32_to_py_buffer(float **symmetric_matrix, Py_ssize_t n) {
+    /* Converts single precision c triangular matrix to a full nxn Matrix (see c_matrix_to_py_buffer), expanded without holding the GIL.
+       Returns NULL on error.
+    Input: 
+        - float **symmetric_matrix: C triangular matrix we want to convert.
+        - Py_ssize_t n: Number of rows and columns in matrix
+    Returns:
+        Created Matrix.
+    */
+    Py_ssize_t i, j;
+    double **matrix;
+    Py_BEGIN_ALLOW_THREADS
+    matrix = continuous_matrix_creation(n, n);
+    for (i = 0; matrix != NULL && i < n; i++) {
+        for (j = i; j < n; j++) {
+            matrix[i][j] = matrix[j][i] = symmetric_matrix[i][j];
+        }
+    }
+    Py_END_ALLOW_THREADS
+    return c_matrix_to_py_buffer(matrix, n, n);
+}
+
+
+PyObject *c_matrix_f32_to_py_buffer(float **matrix, Py_ssize_t m, Py_ssize_t n) {
+    /* Converts single precision c matrix to a Matrix (see c_matrix_to_py_buffer). Returns NULL on error.
+    Input: 
+        - float **matrix: C matrix we want to convert.
+        - Py_ssize_t m: Number of rows in matrix
+        - Py_ssize_t n: Number of columns in matrix
+    Returns:
+        Created Matrix.
+    */
+    Py_ssize_t i, j;
+    double **widened = continuous_matrix_creation(m, n);
+    for (i = 0; widened != NULL && i < m; i++) {
+        for (j = 0; j < n; j++) {
+            widened[i][j] = matrix[i][j];
+        }
+    }
+    return c_matrix_to_py_buffer(widened, m, n);
+}
+
+
+PyObject *c_diagonal_matrix_to_py_buffer(double *diagonal, Py_ssize_t n) {
+    /* Converts c diagonal matrix given by its diagonal alone to a full nxn Matrix (see c_matrix_to_py_buffer), built without holding the
+       GIL. Returns NULL on error.
+    Input: 
+        - double *diagonal: Diagonal of the C matrix we want to convert.
+        - Py_ssize_t n: Number of rows and columns in matrix
+    Returns:
+        Created Matrix.
+    */
+    Py_ssize_t i;
+    double **matrix;
+    Py_BEGIN_ALLOW_THREADS
+    matrix = continuous_matrix_creation(n, n);
+    for (i = 0; matrix != NULL && i < n; i++) {
+        matrix[i][i] = diagonal[i];
+    }
+    Py_END_ALLOW_THREADS
+    return c_matrix_to_py_buffer(matrix, n, n);
+}
+
+
+PyObject *c_result_matrix_to_py(double **matrix, Py_ssize_t m, Py_ssize_t n, int as_buffer) {
+    /* Hands a c continuous matrix computed by a wrapper to Python, as a Matrix taking it over without a copy or as a list of lists.
+       Returns NULL on error, the matrix is freed either way.
+    Input: 
+        - double **matrix: C continuous matrix.
+        - Py_ssize_t m: Number of rows in matrix
+        - Py_ssize_t n: Number of columns in matrix
+        - int as_buffer: Nonzero for a Matrix.
+    Returns:
+        Created python matrix.
+    */
+    PyObject *matrix_py;
+    if (as_buffer) {
+        return c_matrix_to_py_buffer(matrix, m, n);
+    }
+    matrix_py = c_matrix_to_py_matrix(matrix, m, n);
+    free_continuous_matrix(matrix);
+    return matrix_py;
+}
+
+
+int py_precision(const char *precision) {
+    /* Maps a wrapper's precision keyword to the pipeline used. Returns -1 for an unknown precision.
+    Input: 
+        - const char *precision: "double", "single" or "mixed" (SymNMF only, W stored as float while H and every reduction stay double).
+    Returns:
+        0 for double precision, 1 for single precision, 2 for mixed precision.
+    */
+    if (strcmp(precision, "double") == 0) return 0;
+    if (strcmp(precision, "single") == 0) return 1;
+    if (strcmp(precision, "mixed") == 0) return 2;
+    return -1;
+}
+
+
+float **py_symmetric_matrix_to_c_matrix_f32(PyObject *matrix_py_ptr) {
+    /* Converts python symmetric matrix, a list of lists or a float64 buffer, to single precision c triangular matrix, only entries on or
+       above the diagonal are read. Returns NULL on error.
+    Input: 
+        - PyObject *matrix_py_ptr: Python nxn symmetric matrix we want to convert to c matrix
+    Returns:
+        Triangular float c matrix (see triangular_matrix_creation). */
+    PyObject *temp_row_py_ptr, *coord_py_ptr;
+    Py_ssize_t i, j, n;
+    float **matrix;
+    c_matrix_wrapper *matrix_wrapper;
+    if (!PyList_Check(matrix_py_ptr)) {
+        matrix_wrapper = py_buffer_to_c_matrix(matrix_py_ptr);
+        matrix = (matrix_wrapper != NULL && matrix_wrapper->rows == matrix_wrapper->cols) ? triangular_matrix_creation_f32(matrix_wrapper->rows) : NULL;
+        for (i = 0; matrix != NULL && i < matrix_wrapper->rows; i++) {
+            for (j = i; j < matrix_wrapper->cols; j++) {
+                matrix[i][j] = (float)matrix_wrapper->matrix[i][j];
+            }
+        }
+        free_c_matrix_wrapper(matrix_wrapper);
+        return matrix;
+    }
+    n = PyList_Size(matrix_py_ptr);
+    matrix = triangular_matrix_creation_f32(n);
+    if (matrix == NULL) {return NULL;}
+    for (i = 0; i < n; i++) {
+        temp_row_py_ptr = PyList_GetItem(matrix_py_ptr, i);
+        if (!PyList_Check(temp_row_py_ptr) || PyList_Size(temp_row_py_ptr) != n) {
+            free_continuous_matrix_f32(matrix);
+            return NULL;
+        }
+        for (j = i; j < n; j++) {
+            coord_py_ptr = PyList_GetItem(temp_row_py_ptr, j);
+            if (Py_IS_TYPE(coord_py_ptr, &PyFloat_Type) == 0) {
+                free_continuous_matrix_f32(matrix);
+                return NULL;
+            }
+            matrix[i][j] = (float)PyFloat_AsDouble(coord_py_ptr);
+        }
+    }
+    return matrix;
+}
+
+
+PyObject *c_matrix_f32_to_py_matrix(float **matrix, Py_ssize_t m, Py_ssize_t n) {
+    /* Converts single precision c matrix to python matrix
+    Input: 
+        - float **matrix: C matrix we want to convert to Python matrix
+        - Py_ssize_t m: Number of rows in matrix
+        - Py_ssize_t n: Number of columns in matrix
+    Returns:
+        Created python matrix equivalent of given C matrix.
+    */
+    PyObject *matrix_py, *temp_matrix_row_py;
+    Py_ssize_t i, j;
+    matrix_py = PyList_New(m);
+    for (i = 0; i < m; i++) {
+        temp_matrix_row_py = PyList_New(n);
+        PyList_SetItem(matrix_py, i, temp_matrix_row_py);
+        for (j = 0; j < n; j++) {
+            PyList_SetItem(temp_matrix_row_py, j, PyFloat_FromDouble(matrix[i][j]));
+        }
+    }
+    return matrix_py;
+}
+
+
+PyObject *c_symmetric_matrix_f32_to_py_matrix(float **symmetric_matrix, Py_ssize_t n) {
+    /* Converts single precision c triangular matrix to full python matrix
+    Input: 
+        - float **symmetric_matrix: C triangular matrix we want to convert to Python matrix
+        - Py_ssize_t n: Number of rows and columns in matrix
+    Returns:
+        Created python matrix equivalent of given C matrix.
+    */
+    PyObject *matrix_py, *temp_matrix_row_py;
+    Py_ssize_t i, j;
+    matrix_py = PyList_New(n);
+    for (i = 0; i < n; i++) {
+        temp_matrix_row_py = PyList_New(n);
+        PyList_SetItem(matrix_py, i, temp_matrix_row_py);
+        for (j = 0; j < n; j++) {
+            PyList_SetItem(temp_matrix_row_py, j, PyFloat_FromDouble(symmetric_entry_f32(symmetric_matrix, i, j)));
+        }
+    }
+    return matrix_py;
+}
+
+
+PyObject *c_sparse_matrix_to_py_sparse_matrix(csr_matrix *sparse_matrix) {
+    /* Converts c sparse matrix to the python tuple (values, columns, row_offsets) of its compressed sparse row arrays.
+    Input: 
+        - csr_matrix *sparse_matrix: C sparse matrix we want to convert.
+    Returns:
+        Created python tuple of three lists.
+    */
+    PyObject *values_py, *columns_py, *row_offsets_py;
+    Py_ssize_t i;
+    values_py = PyList_New(sparse_matrix->nnz);
+    columns_py = PyList_New(sparse_matrix->nnz);
+    row_offsets_py = PyList_New(sparse_matrix->n + 1);
+    for (i = 0; i < sparse_matrix->nnz; i++) {
+        PyList_SetItem(values_py, i, PyFloat_FromDouble(sparse_matrix->values[i]));
+        PyList_SetItem(columns_py, i, PyLong_FromLong(sparse_matrix->columns[i]));
+    }
+    for (i = 0; i <= sparse_matrix->n; i++) {
+        PyList_SetItem(row_offsets_py, i, PyLong_FromLong(sparse_matrix->row_offsets[i]));
+    }
+    return Py_BuildValue("(NNN)", values_py, columns_py, row_offsets_py);
+}
+
+
+csr_matrix *py_sparse_matrix_to_c_sparse_matrix(PyObject *values_py, PyObject *columns_py, PyObject *row_offsets_py) {
+    /* Converts the python compressed sparse row lists (as returned by sparse_norm) to a c sparse matrix, validating their structure. Returns NULL on error.
+    Input: 
+        - PyObject *values_py: List of stored values.
+        - PyObject *columns_py: List of the column of every stored value.
+        - PyObject *row_offsets_py: List of n + 1 offsets, row i is stored at positions row_offsets[i] ... row_offsets[i + 1] - 1.
+    Returns:
+        C sparse matrix.
+    */
+    Py_ssize_t i, n, nnz;
+    PyObject *item_py;
+    csr_matrix *sparse_matrix;
+    if (!PyList_Check(values_py) || !PyList_Check(columns_py) || !PyList_Check(row_offsets_py)) {return NULL;}
+    n = PyList_Size(row_offsets_py) - 1;
+    nnz = PyList_Size(values_py);
+    if (n < 1 || PyList_Size(columns_py) != nnz) {return NULL;}
+    sparse_matrix = csr_matrix_creation(n, nnz);
+    if (sparse_matrix == NULL) {return NULL;}
+    for (i = 0; i <= n; i++) {
+        sparse_matrix->row_offsets[i] = (int)PyLong_AsLong(PyList_GetItem(row_offsets_py, i));
+        if ((i == 0 && sparse_matrix->row_offsets[i] != 0) || (i > 0 && sparse_matrix->row_offsets[i] < sparse_matrix->row_offsets[i - 1])) {
+            free_csr_matrix(sparse_matrix);
+            return NULL;
+        }
+    }
+    if (sparse_matrix->row_offsets[n] != nnz) {
+        free_csr_matrix(sparse_matrix);
+        return NULL;
+    }
+    for (i = 0; i < nnz; i++) {
+        item_py = PyList_GetItem(values_py, i);
+        sparse_matrix->columns[i] = (int)PyLong_AsLong(PyList_GetItem(columns_py, i));
+        if (Py_IS_TYPE(item_py, &PyFloat_Type) == 0 || sparse_matrix->columns[i] < 0 || sparse_matrix->columns[i] >= n) {
+            free_csr_matrix(sparse_matrix);
+            return NULL;
+        }
+        sparse_matrix->values[i] = PyFloat_AsDouble(item_py);
+    }
+    return sparse_matrix;
+}
+
+
+void wrapper_function_memory_deallocator(double **sim_matrix, double **diag_matrix, double **normal_matrix, double **symnmf_matrix, c_matrix_wrapper *matrix_wrapper_1, c_matrix_wrapper *matrix_wrapper_2) {
+    /* Frees up main project matrices and datapoints wrapper for convenience. 
+    Input: 
+        Items can be NULL as free_continuous_matrix and free which are used here handle it. Includes error print.
+        - double sim_matrix[][]: Matrix 1 we are freeing.
+        - double diag_matrix[][]: Matrix 2 we are freeing.
+        - double normal_matrix[][]: Matrix 3 we are freeing.
+        - c_matrix_wrapper *matrix_wrapper_1: Wrapper 1 for matrix we are freeing.
+        - c_matrix_wrapper *matrix_wrapper_2: Wrapper 2 for matrix we are freeing.
+    */
+    free_continuous_matrix(sim_matrix);
+    free_continuous_matrix(diag_matrix);
+    free_continuous_matrix(normal_matrix);
+    free_continuous_matrix(symnmf_matrix);
+    free_c_matrix_wrapper(matrix_wrapper_1);
+    free_c_matrix_wrapper(matrix_wrapper_2);
+}
+
+
+void wrapper_function_error_handler(double **sim_matrix, double **diag_matrix, double **normal_matrix, double **symnmf_matrix, c_matrix_wrapper *matrix_wrapper_1, c_matrix_wrapper *matrix_wrapper_2) {
+    /* Handles errors in project's main wrapper functions by deallocating memory, printing standard error message and exiting program.
+    Input: 
+        Items can be NULL as free_continuous_matrix and free which are used here handle it. Includes error print.
+        - double sim_matrix[][]: Matrix 1 we are freeing.
+        - double diag_matrix[][]: Matrix 2 we are freeing.
+        - double normal_matrix[][]: Matrix 3 we are freeing.
+        - c_matrix_wrapper *matrix_wrapper_1: Wrapper 1 for matrix we are freeing.
+        - c_matrix_wrapper *matrix_wrapper_2: Wrapper 2 for matrix we are freeing.
+    */
+    printf("An Error Has Occurred\n");
+    wrapper_function_memory_deallocator(sim_matrix, diag_matrix, normal_matrix, symnmf_matrix, matrix_wrapper_1, matrix_wrapper_2);
+    exit(EXIT_FAILURE);
+}
+
+
+static PyObject* sym_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating similarity matrix in C and returning it to Python program. Fully handles errors by deallocating memory and exiting program.
+    Input: 
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function. 
+        - PyObject *kwargs: precision ("double", the default, or "single" to calculate and store the matrix as float) and
+          exact (True to evaluate the exponentials with libm, bit exact, instead of the vectorized kernel, defaults to False).
+    Returns:
+        Python similarity matrix, a Matrix if the datapoints were given as a buffer.
+    */
+    static char *keywords[] = {"points", "precision", "exact", NULL};
+    PyObject *datapoints_matrix_py_ptr, *sym_matrix_py_ptr;
+    c_matrix_wrapper *datapoints_wrapper;
+    double **sim_matrix;
+    float **sim_matrix_f32;
+    const char *precision = "double";
+    int single_precision, as_buffer, exact = 0;
+    
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sp", keywords, &datapoints_matrix_py_ptr, &precision, &exact) ||
+        (single_precision = py_precision(precision)) < 0 || single_precision > 1) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    as_buffer = py_is_buffer_matrix(datapoints_matrix_py_ptr);
+    datapoints_wrapper = py_matrix_to_c_matrix(datapoints_matrix_py_ptr);
+    if (datapoints_wrapper == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    if (single_precision) {
+        Py_BEGIN_ALLOW_THREADS
+        sim_matrix_f32 = similarity_matrix_f32(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, exact);
+        Py_END_ALLOW_THREADS
+        if (sim_matrix_f32 == NULL) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+        }
+        sym_matrix_py_ptr = as_buffer ? c_symmetric_matrix_f32_to_py_buffer(sim_matrix_f32, datapoints_wrapper->rows) :
+                                        c_symmetric_matrix_f32_to_py_matrix(sim_matrix_f32, datapoints_wrapper->rows);
+        free_continuous_matrix_f32(sim_matrix_f32);
+        if (sym_matrix_py_ptr == NULL) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+        }
+        wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+        return sym_matrix_py_ptr;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    sim_matrix = similarity_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, exact);
+    Py_END_ALLOW_THREADS
+    if (sim_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    sym_matrix_py_ptr = as_buffer ? c_symmetric_matrix_to_py_buffer(sim_matrix, datapoints_wrapper->rows) :
+                                    c_symmetric_matrix_to_py_matrix(sim_matrix, datapoints_wrapper->rows);
+    if (sym_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(sim_matrix, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    wrapper_function_memory_deallocator(sim_matrix, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    return sym_matrix_py_ptr;
+}
+
+
+static PyObject* diag_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating diagonal matrix in C and returning it to Python program. Fully handles error by deallocating memory and exiting program.
+    Input: 
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function.     
+        - PyObject *kwargs: precision ("double", the default, or "single", the same
+          since the degrees are always summed in double precision) and
+          exact (True to evaluate the exponentials with libm, bit exact, instead of the vectorized kernel, defaults to False).
+    Returns:
+        Python diagonal matrix, a Matrix if the datapoints were given as a buffer.
+    */
+    static char *keywords[] = {"points", "precision", "exact", NULL};
+    PyObject *datapoints_matrix_py_ptr, *diag_matrix_py_ptr;
+    c_matrix_wrapper *datapoints_wrapper;
+    double *degrees;
+    const char *precision = "double";
+    int single_precision, as_buffer, exact = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sp", keywords, &datapoints_matrix_py_ptr, &precision, &exact) ||
+        (single_precision = py_precision(precision)) < 0 || single_precision > 1) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    as_buffer = py_is_buffer_matrix(datapoints_matrix_py_ptr);
+
+    datapoints_wrapper = py_matrix_to_c_matrix(datapoints_matrix_py_ptr);
+    if (datapoints_wrapper == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    Py_BEGIN_ALLOW_THREADS
+    degrees = diagonal_vector(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, exact);
+    Py_END_ALLOW_THREADS
+    if (degrees == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    diag_matrix_py_ptr = as_buffer ? c_diagonal_matrix_to_py_buffer(degrees, datapoints_wrapper->rows) :
+                                     c_diagonal_matrix_to_py_matrix(degrees, datapoints_wrapper->rows);
+    free(degrees);
+    if (diag_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    return diag_matrix_py_ptr;;
+}
+
+
+static PyObject* norm_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating norm matrix in C and returning it to Python program. Fully handles errors by deallocating memory and exiting program.
+    Input: 
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function. 
+        - PyObject *kwargs: precision ("double", the default, or "single" to calculate and store the matrix as float) and
+          exact (True to evaluate the exponentials with libm, bit exact, instead of the vectorized kernel, defaults to False).
+    Returns:
+        Python norm matrix, a Matrix if the datapoints were given as a buffer.
+    */
+    static char *keywords[] = {"points", "precision", "exact", NULL};
+    PyObject *datapoints_matrix_py_ptr, *norm_matrix_py_ptr;
+    c_matrix_wrapper *datapoints_wrapper;
+    double **nm_matrix;
+    float **nm_matrix_f32;
+    const char *precision = "double";
+    int single_precision, as_buffer, exact = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sp", keywords, &datapoints_matrix_py_ptr, &precision, &exact) ||
+        (single_precision = py_precision(precision)) < 0 || single_precision > 1) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    as_buffer = py_is_buffer_matrix(datapoints_matrix_py_ptr);
+    datapoints_wrapper = py_matrix_to_c_matrix(datapoints_matrix_py_ptr);
+    if (datapoints_wrapper == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    if (single_precision) {
+        Py_BEGIN_ALLOW_THREADS
+        nm_matrix_f32 = fused_norm_matrix_f32(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, exact);
+        Py_END_ALLOW_THREADS
+        if (nm_matrix_f32 == NULL) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+        }
+        norm_matrix_py_ptr = as_buffer ? c_symmetric_matrix_f32_to_py_buffer(nm_matrix_f32, datapoints_wrapper->rows) :
+                                         c_symmetric_matrix_f32_to_py_matrix(nm_matrix_f32, datapoints_wrapper->rows);
+        free_continuous_matrix_f32(nm_matrix_f32);
+        if (norm_matrix_py_ptr == NULL) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+        }
+        wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+        return norm_matrix_py_ptr;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    nm_matrix = fused_norm_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, exact);
+    Py_END_ALLOW_THREADS
+    if (nm_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    norm_matrix_py_ptr = as_buffer ? c_symmetric_matrix_to_py_buffer(nm_matrix, datapoints_wrapper->rows) :
+                                     c_symmetric_matrix_to_py_matrix(nm_matrix, datapoints_wrapper->rows);
+    if (norm_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, nm_matrix, NULL, datapoints_wrapper, NULL);
+    }
+    wrapper_function_memory_deallocator(NULL, NULL, nm_matrix, NULL, datapoints_wrapper, NULL);
+    return norm_matrix_py_ptr;;
+}
+
+
+int py_solver_callback(int iteration, double step, double objective, double elapsed, void *context) {
+    /* Solver callback forwarding every iteration's report to a Python callable as callable(iteration, step, objective, elapsed).
+    Input: 
+        - int iteration, double step, double objective, double elapsed: The iteration's report, see solver_iteration_report.
+        - void *context: The Python callable.
+    Returns:
+        Nonzero (stop iterating) if the callable returned a true value or raised, in which case the exception is left set. Once it has
+        raised it is not called again, later restarts stop right away. The solver runs without the GIL, it is taken for the call.
+    */
+    int stop = 1;
+    PyObject *result_py_ptr;
+    PyGILState_STATE gil_state = PyGILState_Ensure();
+    if (!PyErr_Occurred()) {
+        result_py_ptr = PyObject_CallFunction((PyObject *)context, "iddd", iteration, step, objective, elapsed);
+        if (result_py_ptr != NULL) {
+            stop = PyObject_IsTrue(result_py_ptr) != 0;
+            Py_DECREF(result_py_ptr);
+        }
+    }
+    PyGILState_Release(gil_state);
+    return stop;
+}
+
+
+int py_solver_options(const char *solver, double beta, double epsilon, int max_iter, PyObject *callback_py_ptr, solver_options *options) {
+    /* Fills solver options from a SymNMF wrapper's keyword arguments. Returns -1 if any of them is invalid, 0 otherwise.
+       These are the solver keyword arguments every SymNMF wrapper (symnmf, sparse_symnmf, low_rank_symnmf, mapped_symnmf and fit) takes:
+        - solver: "mu" for the damped multiplicative updates (the default), "anls", "hals" or "amu".
+        - beta: Damping of the multiplicative updates, defaults to 0.5.
+        - epsilon: Convergence threshold, defaults to 1e-4.
+        - max_iter: Maximum number of iterations, defaults to 300.
+        - callback: Called as callback(iteration, step, objective, elapsed) after every iteration, a true return value stops the solve,
+          an exception stops it and is raised. Defaults to None.
+    Input: 
+        - const char *solver: Name of the update rule, "mu", "anls", "hals" or "amu".
+        - double beta: Damping of the multiplicative updates, in (0, 1].
+        - double epsilon: Convergence threshold on ||H_t+1 - H_t||_F^2, nonnegative.
+        - int max_iter: Maximum number of iterations, positive.
+        - PyObject *callback_py_ptr: Python callable called after every iteration, or None.
+        - solver_options *options: Options to fill.
+    */
+    int method = solver_method_from_name(solver);
+    if (method < 0 || !(beta > 0.0 && beta <= 1.0) || !(epsilon >= 0.0) || max_iter <= 0) {
+        return -1;
+    }
+    if (callback_py_ptr != Py_None && !PyCallable_Check(callback_py_ptr)) {
+        return -1;
+    }
+    solver_options_defaults(options);
+    options->method = (solver_method)method;
+    options->beta = beta;
+    options->epsilon = epsilon;
+    options->max_iter = max_iter;
+    if (callback_py_ptr != Py_None) {
+        options->callback = py_solver_callback;
+        options->callback_context = callback_py_ptr;
+    }
+    return 0;
+}
+
+
+double **py_symnmf_solve(PyObject *initial_H_py_ptr, norm_operator *W, int restarts, unsigned long seed, const solver_options *options, int *k) {
+    /* Runs SymNMF on W from the first argument of a SymNMF wrapper, which is either an initial H (solved from once) or the number of columns k,
+       in which case initial H's are created in C and restarts of them are solved (see converge_H_restarts), keeping the best. Returns NULL on error, with
+       a Python exception set if the callback raised one.
+    Input: 
+        - PyObject *initial_H_py_ptr: Python initial H (list of lists or float64 buffer) or Python int k.
+        - norm_operator *W: Norm matrix.
+        - int restarts: Number of restarts, must be 1 when an initial H is given.
+        - unsigned long seed: Seed of the first restart's initial H (restart r uses seed + r).
+        - const solver_options *options: Options every solve uses.
+        - int *k: Set to the number of columns in the result.
+    Returns:
+        Final iteration of H (of the best restart).
+    */
+    double **symnmf_matrix;
+    c_matrix_wrapper *initial_H_wrapper;
+    if (PyLong_Check(initial_H_py_ptr)) {
+        *k = (int)PyLong_AsLong(initial_H_py_ptr);
+        if (*k <= 0 || *k >= W->n || restarts <= 0) {
+            return NULL;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        symnmf_matrix = converge_H_restarts(W, W->n, *k, restarts, seed, options, NULL);
+        Py_END_ALLOW_THREADS
+        if (symnmf_matrix != NULL && PyErr_Occurred()) {
+            free_continuous_matrix(symnmf_matrix);
+            return NULL;
+        }
+        return symnmf_matrix;
+    }
+    if (restarts != 1) {
+        return NULL;
+    }
+    initial_H_wrapper = py_matrix_to_c_matrix(initial_H_py_ptr);
+    if (initial_H_wrapper == NULL) {
+        return NULL;
+    }
+    *k = initial_H_wrapper->cols;
+    symnmf_matrix = NULL;
+    if (initial_H_wrapper->rows == W->n) {
+        Py_BEGIN_ALLOW_THREADS
+        symnmf_matrix = converge_H(initial_H_wrapper->matrix, W, W->n, *k, options);
+        Py_END_ALLOW_THREADS
+    }
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, initial_H_wrapper, NULL);
+    if (symnmf_matrix != NULL && PyErr_Occurred()) {
+        free_continuous_matrix(symnmf_matrix);
+        return NULL;
+    }
+    return symnmf_matrix;
+}
+
+
+PyObject *py_symnmf_solve_f32(PyObject *initial_H_py_ptr, PyObject *norm_matrix_py_ptr, int restarts, const solver_options *options, int as_buffer) {
+    /* Runs SymNMF in single precision from the arguments of the dense SymNMF wrapper, converting W and the initial H to float and the result
+       back. Only a given initial H (solved from once) and the damped multiplicative update are supported. Returns NULL on error, with a
+       Python exception set if the callback raised one.
+    Input: 
+        - PyObject *initial_H_py_ptr: Python initial H (list of lists or float64 buffer).
+        - PyObject *norm_matrix_py_ptr: Python norm matrix (list of lists or float64 buffer).
+        - int restarts: Number of restarts, must be 1.
+        - const solver_options *options: Options of the solve, its method must be multiplicative_solver.
+        - int as_buffer: Nonzero to return H as a Matrix (see c_matrix_to_py_buffer) instead of a list of lists.
+    Returns:
+        Python final iteration of H.
+    */
+    PyObject *symnmf_matrix_py_ptr;
+    c_matrix_wrapper *initial_H_wrapper;
+    float **nm_matrix, **initial_H = NULL, **symnmf_matrix = NULL;
+    Py_ssize_t i, j, n;
+    n = PyObject_Length(norm_matrix_py_ptr);
+    if (restarts != 1 || n <= 0) {
+        PyErr_Clear();
+        return NULL;
+    }
+    nm_matrix = py_symmetric_matrix_to_c_matrix_f32(norm_matrix_py_ptr);
+    initial_H_wrapper = py_matrix_to_c_matrix(initial_H_py_ptr);
+    if (nm_matrix != NULL && initial_H_wrapper != NULL && initial_H_wrapper->rows == n) {
+        initial_H = continuous_matrix_creation_f32(n, initial_H_wrapper->cols);
+    }
+    if (initial_H != NULL) {
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < initial_H_wrapper->cols; j++) {
+                initial_H[i][j] = (float)initial_H_wrapper->matrix[i][j];
             }
-            wrapper->matrix[i][j] = PyFloat_AsDouble(coord_py_ptr);
         }
+        Py_BEGIN_ALLOW_THREADS
+        symnmf_matrix = converge_H_f32(initial_H, nm_matrix, n, initial_H_wrapper->cols, options);
+        Py_END_ALLOW_THREADS
     }
-    return wrapper;
+    symnmf_matrix_py_ptr = NULL;
+    if (symnmf_matrix != NULL && !PyErr_Occurred()) {
+        symnmf_matrix_py_ptr = as_buffer ? c_matrix_f32_to_py_buffer(symnmf_matrix, n, initial_H_wrapper->cols) :
+                                           c_matrix_f32_to_py_matrix(symnmf_matrix, n, initial_H_wrapper->cols);
+    }
+    free_continuous_matrix_f32(nm_matrix);
+    free_continuous_matrix_f32(initial_H);
+    free_continuous_matrix_f32(symnmf_matrix);
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, initial_H_wrapper, NULL);
+    return symnmf_matrix_py_ptr;
 }
 
 
-PyObject *c_matrix_to_py_matrix(double **matrix, Py_ssize_t m, Py_ssize_t n) {
-    /* Converts c matrix to python matrix
+static PyObject* symnmf_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating SymNMF matrix in C and returning it to Python program. Fully handles errors by deallocating memory and exiting program.
     Input: 
-        - double **matrix: C matrix we want to convert to Python matrix
-        - Py_ssize_t m: Number of rows in matrix
-        - Py_ssize_t n: Number of columns in matrix
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function, initial H (or the number of columns k) and the norm matrix. 
+        - PyObject *kwargs: restarts (number of C initialized restarts when k is given, defaults to 1), seed (seed of the first one, defaults
+          to 1234), precision ("double", the default, "single" to solve in float, only with an initial H and the "mu" solver, or "mixed" to
+          store W as float while H, its products and every reduction stay double) and the solver options (see py_solver_options).
+          A float64 buffer W is solved from in place in double precision.
     Returns:
-        Created python matrix equivalent of given C matrix.
+        Python symnmf matrix, a Matrix if H or W was given as a buffer.
     */
-    PyObject *matrix_py, *temp_matrix_row_py, *matrix_entry_py;
-    Py_ssize_t i, j;
-    matrix_py = PyList_New(m);
-    for (i = 0; i < m; i++) {
-        temp_matrix_row_py = PyList_New(n);
-        PyList_SetItem(matrix_py, i, temp_matrix_row_py);
-        for (j = 0; j < n; j++) {
-            matrix_entry_py = PyFloat_FromDouble(matrix[i][j]);
-            PyList_SetItem(temp_matrix_row_py, j, matrix_entry_py);
+    static char *keywords[] = {"H", "W", "restarts", "seed", "solver", "beta", "epsilon", "max_iter", "callback", "precision", NULL};
+    double **symnmf_matrix, **nm_matrix = NULL;
+    float **nm_matrix_f32 = NULL;
+    c_matrix_wrapper *norm_wrapper = NULL;
+    norm_operator W;
+    int k, restarts = 1, precision_mode, as_buffer;
+    int max_iter = 300;
+    double beta = 0.5, epsilon = 1e-4;
+    const char *solver = "mu", *precision = "double";
+    unsigned long seed = 1234;
+    solver_options options;
+    PyObject *initial_H_py_ptr, *norm_matrix_py_ptr, *symnmf_matrix_py_ptr, *callback_py_ptr = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|iksddiOs", keywords, &initial_H_py_ptr, &norm_matrix_py_ptr, &restarts, &seed, &solver,
+                                     &beta, &epsilon, &max_iter, &callback_py_ptr, &precision) ||
+        py_solver_options(solver, beta, epsilon, max_iter, callback_py_ptr, &options) != 0 || (precision_mode = py_precision(precision)) < 0) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    as_buffer = py_is_buffer_matrix(initial_H_py_ptr) || py_is_buffer_matrix(norm_matrix_py_ptr);
+    if (precision_mode == 1) {
+        symnmf_matrix_py_ptr = py_symnmf_solve_f32(initial_H_py_ptr, norm_matrix_py_ptr, restarts, &options, as_buffer);
+        if (symnmf_matrix_py_ptr == NULL && !PyErr_Occurred()) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
         }
+        return symnmf_matrix_py_ptr;
     }
-    return matrix_py;
+    if (precision_mode == 2) {
+        nm_matrix_f32 = py_symmetric_matrix_to_c_matrix_f32(norm_matrix_py_ptr);
+    }
+    else if (PyList_Check(norm_matrix_py_ptr)) {
+        nm_matrix = py_symmetric_matrix_to_c_matrix(norm_matrix_py_ptr);
+    }
+    else {
+        norm_wrapper = py_buffer_to_c_matrix(norm_matrix_py_ptr); /* A full matrix is a valid triangular one, see triangular_matrix_creation */
+        if (norm_wrapper != NULL && norm_wrapper->rows != norm_wrapper->cols) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, norm_wrapper, NULL);
+        }
+    }
+    if (nm_matrix == NULL && nm_matrix_f32 == NULL && norm_wrapper == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    W.representation = (precision_mode == 2) ? single_dense_norm : dense_norm;
+    W.n = (int)PyObject_Length(norm_matrix_py_ptr);
+    W.dense = (norm_wrapper != NULL) ? norm_wrapper->matrix : nm_matrix;
+    W.single_dense = nm_matrix_f32;
+    W.mapped = NULL;
+    W.sparse = NULL;
+    W.low_rank = NULL;
+    symnmf_matrix = py_symnmf_solve(initial_H_py_ptr, &W, restarts, seed, &options, &k);
+    free_continuous_matrix_f32(nm_matrix_f32);
+    if (symnmf_matrix == NULL && PyErr_Occurred()) {
+        wrapper_function_memory_deallocator(NULL, NULL, nm_matrix, NULL, norm_wrapper, NULL);
+        return NULL;
+    }
+    if (symnmf_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, nm_matrix, NULL, norm_wrapper, NULL);
+    }
+    symnmf_matrix_py_ptr = c_result_matrix_to_py(symnmf_matrix, W.n, k, as_buffer);
+    if (symnmf_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, nm_matrix, NULL, norm_wrapper, NULL);
+    }
+    wrapper_function_memory_deallocator(NULL, NULL, nm_matrix, NULL, norm_wrapper, NULL);
+    return symnmf_matrix_py_ptr;
 }
 
 
-void wrapper_function_memory_deallocator(double **sim_matrix, double **diag_matrix, double **normal_matrix, double **symnmf_matrix, c_matrix_wrapper *matrix_wrapper_1, c_matrix_wrapper *matrix_wrapper_2) {
-    /* Frees up main project matrices and datapoints wrapper for convenience. 
+static PyObject* sparse_norm_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating the sparse norm matrix in C and returning it to Python program as a (values, columns, row_offsets) tuple.
+       Fully handles errors by deallocating memory and exiting program.
     Input: 
-        Items can be NULL as free_continuous_matrix and free which are used here handle it. Includes error print.
-        - double sim_matrix[][]: Matrix 1 we are freeing.
-        - double diag_matrix[][]: Matrix 2 we are freeing.
-        - double normal_matrix[][]: Matrix 3 we are freeing.
-        - c_matrix_wrapper *matrix_wrapper_1: Wrapper 1 for matrix we are freeing.
-        - c_matrix_wrapper *matrix_wrapper_2: Wrapper 2 for matrix we are freeing.
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function, the datapoints.
+        - PyObject *kwargs: neighbours (number of nearest neighbours kept per point) and threshold (smallest similarity kept), at least one must be positive.
+    Returns:
+        Python sparse norm matrix
     */
-    free_continuous_matrix(sim_matrix);
-    free_continuous_matrix(diag_matrix);
-    free_continuous_matrix(normal_matrix);
-    free_continuous_matrix(symnmf_matrix);
-    if (matrix_wrapper_1 != NULL) {
-        free_matrix(matrix_wrapper_1->matrix, matrix_wrapper_1->rows);
-        free(matrix_wrapper_1);
+    static char *keywords[] = {"points", "neighbours", "threshold", NULL};
+    PyObject *datapoints_matrix_py_ptr, *norm_matrix_py_ptr;
+    c_matrix_wrapper *datapoints_wrapper;
+    csr_matrix *sparse_matrix;
+    double *degrees;
+    int neighbours = 0;
+    double threshold = 0.0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|id", keywords, &datapoints_matrix_py_ptr, &neighbours, &threshold)) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    datapoints_wrapper = py_matrix_to_c_matrix(datapoints_matrix_py_ptr);
+    if (datapoints_wrapper == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    Py_BEGIN_ALLOW_THREADS
+    sparse_matrix = sparse_similarity_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, neighbours, threshold);
+    degrees = (sparse_matrix != NULL) ? sparse_diagonal(sparse_matrix) : NULL;
+    if (degrees != NULL) {
+        sparse_norm_matrix(sparse_matrix, degrees);
+    }
+    Py_END_ALLOW_THREADS
+    if (sparse_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
     }
-    if (matrix_wrapper_2 != NULL) {
-    free_matrix(matrix_wrapper_2->matrix, matrix_wrapper_2->rows);
-    free(matrix_wrapper_2);
+    if (degrees == NULL) {
+        free_csr_matrix(sparse_matrix);
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
     }
+    norm_matrix_py_ptr = c_sparse_matrix_to_py_sparse_matrix(sparse_matrix);
+    free_csr_matrix(sparse_matrix);
+    free(degrees);
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    return norm_matrix_py_ptr;
 }
 
 
-void wrapper_function_error_handler(double **sim_matrix, double **diag_matrix, double **normal_matrix, double **symnmf_matrix, c_matrix_wrapper *matrix_wrapper_1, c_matrix_wrapper *matrix_wrapper_2) {
-    /* Handles errors in project's main wrapper functions by deallocating memory, printing standard error message and exiting program.
+static PyObject* sparse_symnmf_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating SymNMF matrix in C from a sparse norm matrix and returning it to Python program. 
+       Fully handles errors by deallocating memory and exiting program.
     Input: 
-        Items can be NULL as free_continuous_matrix and free which are used here handle it. Includes error print.
-        - double sim_matrix[][]: Matrix 1 we are freeing.
-        - double diag_matrix[][]: Matrix 2 we are freeing.
-        - double normal_matrix[][]: Matrix 3 we are freeing.
-        - c_matrix_wrapper *matrix_wrapper_1: Wrapper 1 for matrix we are freeing.
-        - c_matrix_wrapper *matrix_wrapper_2: Wrapper 2 for matrix we are freeing.
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function, initial H (or the number of columns k) and the (values, columns, row_offsets) tuple returned by sparse_norm.
+        - PyObject *kwargs: restarts (number of C initialized restarts when k is given, defaults to 1), seed (seed of the first one, defaults
+          to 1234) and the solver options (see py_solver_options).
+    Returns:
+        Python symnmf matrix, a Matrix if H was given as a buffer.
     */
-    printf("An Error Has Occurred\n");
-    wrapper_function_memory_deallocator(sim_matrix, diag_matrix, normal_matrix, symnmf_matrix, matrix_wrapper_1, matrix_wrapper_2);
-    exit(EXIT_FAILURE);
+    static char *keywords[] = {"H", "W", "restarts", "seed", "solver", "beta", "epsilon", "max_iter", "callback", NULL};
+    double **symnmf_matrix;
+    norm_operator W;
+    int k, restarts = 1;
+    int max_iter = 300;
+    double beta = 0.5, epsilon = 1e-4;
+    const char *solver = "mu";
+    unsigned long seed = 1234;
+    solver_options options;
+    PyObject *initial_H_py_ptr, *values_py_ptr, *columns_py_ptr, *row_offsets_py_ptr, *symnmf_matrix_py_ptr, *callback_py_ptr = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O(OOO)|iksddiO", keywords, &initial_H_py_ptr, &values_py_ptr, &columns_py_ptr, &row_offsets_py_ptr, &restarts, &seed, &solver,
+                                     &beta, &epsilon, &max_iter, &callback_py_ptr) ||
+        py_solver_options(solver, beta, epsilon, max_iter, callback_py_ptr, &options) != 0) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    W.representation = sparse_norm;
+    W.dense = NULL;
+    W.single_dense = NULL;
+    W.mapped = NULL;
+    W.low_rank = NULL;
+    W.sparse = py_sparse_matrix_to_c_sparse_matrix(values_py_ptr, columns_py_ptr, row_offsets_py_ptr);
+    if (W.sparse == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    W.n = W.sparse->n;
+    symnmf_matrix = py_symnmf_solve(initial_H_py_ptr, &W, restarts, seed, &options, &k);
+    free_csr_matrix(W.sparse);
+    if (symnmf_matrix == NULL && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (symnmf_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    symnmf_matrix_py_ptr = c_result_matrix_to_py(symnmf_matrix, W.n, k, py_is_buffer_matrix(initial_H_py_ptr));
+    if (symnmf_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    return symnmf_matrix_py_ptr;
 }
 
 
-static PyObject* sym_c_wrapper(PyObject *self, PyObject *args) {
-    /* Python-C Extension wrapper for calculating similarity matrix in C and returning it to Python program. Fully handles errors by deallocating memory and exiting program.
+static PyObject* nystrom_norm_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating the Nystrom low rank norm matrix W = G * G^T - diag(shift) in C and returning it to Python program
+       as a (G, shift) tuple. Fully handles errors by deallocating memory and exiting program.
     Input: 
         - PyObject *self: reference to wrapper.
-        - PyObject *args: Python arguments calling c function. 
+        - PyObject *args: Python arguments calling c function, the datapoints and the number of landmarks.
+        - PyObject *kwargs: seed (seed of the landmark sampling, defaults to 1234).
     Returns:
-        Python similarity matrix
+        Python low rank norm matrix, G is a Matrix if the datapoints were given as a buffer.
     */
-    PyObject *datapoints_matrix_py_ptr, *sym_matrix_py_ptr;
+    static char *keywords[] = {"points", "landmarks", "seed", NULL};
+    PyObject *datapoints_matrix_py_ptr, *factor_py_ptr, *shift_py_ptr;
     c_matrix_wrapper *datapoints_wrapper;
-    double **sim_matrix;
-    
-    if (!PyArg_ParseTuple(args, "O", &datapoints_matrix_py_ptr)) {
-        printf("An Error Has Occurred\n");
-        exit(EXIT_FAILURE);
-    }
-    if (!PyList_Check(datapoints_matrix_py_ptr)) {
+    low_rank_matrix *low_rank;
+    double *degrees;
+    Py_ssize_t i;
+    int landmarks;
+    unsigned long seed = 1234;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|k", keywords, &datapoints_matrix_py_ptr, &landmarks, &seed)) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
@@ -158,158 +1252,452 @@ static PyObject* sym_c_wrapper(PyObject *self, PyObject *args) {
     if (datapoints_wrapper == NULL) {
         wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
     }
-    sim_matrix = similarity_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols);
-    if (sim_matrix == NULL) {
+    Py_BEGIN_ALLOW_THREADS
+    low_rank = nystrom_similarity_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, landmarks, seed);
+    degrees = (low_rank != NULL) ? low_rank_diagonal(low_rank) : NULL;
+    if (degrees != NULL) {
+        low_rank_norm_matrix(low_rank, degrees);
+    }
+    Py_END_ALLOW_THREADS
+    if (low_rank == NULL) {
         wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
     }
-    sym_matrix_py_ptr = c_matrix_to_py_matrix(sim_matrix, datapoints_wrapper->rows, datapoints_wrapper->rows);
-    wrapper_function_memory_deallocator(sim_matrix, NULL, NULL, NULL, datapoints_wrapper, NULL);
-    return sym_matrix_py_ptr;
+    if (degrees == NULL) {
+        free_low_rank_matrix(low_rank);
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    factor_py_ptr = py_is_buffer_matrix(datapoints_matrix_py_ptr) ? c_matrix_to_py_buffer(copy_c_matrix(low_rank->factor, low_rank->n, low_rank->rank), low_rank->n, low_rank->rank) :
+                                                                    c_matrix_to_py_matrix(low_rank->factor, low_rank->n, low_rank->rank);
+    if (factor_py_ptr == NULL) {
+        free_low_rank_matrix(low_rank);
+        free(degrees);
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    shift_py_ptr = PyList_New(low_rank->n);
+    for (i = 0; i < low_rank->n; i++) {
+        PyList_SetItem(shift_py_ptr, i, PyFloat_FromDouble(low_rank->diagonal_shift[i]));
+    }
+    free_low_rank_matrix(low_rank);
+    free(degrees);
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    return Py_BuildValue("(NN)", factor_py_ptr, shift_py_ptr);
 }
 
 
-static PyObject* diag_c_wrapper(PyObject *self, PyObject *args) {
-    /* Python-C Extension wrapper for calculating diagonal matrix in C and returning it to Python program. Fully handles error by deallocating memory and exiting program.
+static PyObject* low_rank_symnmf_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating SymNMF matrix in C from a low rank norm matrix and returning it to Python program. 
+       Fully handles errors by deallocating memory and exiting program.
     Input: 
         - PyObject *self: reference to wrapper.
-        - PyObject *args: Python arguments calling c function.     
+        - PyObject *args: Python arguments calling c function, initial H (or the number of columns k) and the (G, shift) tuple returned by nystrom_norm.
+        - PyObject *kwargs: restarts (number of C initialized restarts when k is given, defaults to 1), seed (seed of the first one, defaults
+          to 1234) and the solver options (see py_solver_options).
     Returns:
-        Python diagonal matrix
+        Python symnmf matrix, a Matrix if H or G was given as a buffer.
     */
-    PyObject *datapoints_matrix_py_ptr, *diag_matrix_py_ptr;
-    c_matrix_wrapper *datapoints_wrapper;
-    double **sim_matrix, **diag_matrix;
-
-    if (!PyArg_ParseTuple(args, "O", &datapoints_matrix_py_ptr)) {
+    static char *keywords[] = {"H", "W", "restarts", "seed", "solver", "beta", "epsilon", "max_iter", "callback", NULL};
+    double **symnmf_matrix;
+    norm_operator W;
+    low_rank_matrix low_rank;
+    c_matrix_wrapper *factor_wrapper;
+    int k, restarts = 1;
+    int max_iter = 300;
+    double beta = 0.5, epsilon = 1e-4;
+    const char *solver = "mu";
+    unsigned long seed = 1234;
+    solver_options options;
+    PyObject *initial_H_py_ptr, *factor_py_ptr, *shift_py_ptr, *symnmf_matrix_py_ptr, *item_py, *callback_py_ptr = Py_None;
+    Py_ssize_t i;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O(OO)|iksddiO", keywords, &initial_H_py_ptr, &factor_py_ptr, &shift_py_ptr, &restarts, &seed, &solver,
+                                     &beta, &epsilon, &max_iter, &callback_py_ptr) ||
+        py_solver_options(solver, beta, epsilon, max_iter, callback_py_ptr, &options) != 0) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
-    if (!PyList_Check(datapoints_matrix_py_ptr)) {
+    if (!PyList_Check(shift_py_ptr)) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
+    factor_wrapper = py_matrix_to_c_matrix(factor_py_ptr);
+    if (factor_wrapper == NULL || factor_wrapper->rows != PyList_Size(shift_py_ptr)) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+    }
+    low_rank.n = factor_wrapper->rows;
+    low_rank.rank = factor_wrapper->cols;
+    low_rank.factor = factor_wrapper->matrix;
+    low_rank.diagonal_shift = malloc(low_rank.n * sizeof(double));
+    if (low_rank.diagonal_shift == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+    }
+    for (i = 0; i < low_rank.n; i++) {
+        item_py = PyList_GetItem(shift_py_ptr, i);
+        if (Py_IS_TYPE(item_py, &PyFloat_Type) == 0) {
+            free(low_rank.diagonal_shift);
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+        }
+        low_rank.diagonal_shift[i] = PyFloat_AsDouble(item_py);
+    }
+    W.representation = low_rank_norm;
+    W.n = low_rank.n;
+    W.dense = NULL;
+    W.single_dense = NULL;
+    W.mapped = NULL;
+    W.sparse = NULL;
+    W.low_rank = &low_rank;
+    symnmf_matrix = py_symnmf_solve(initial_H_py_ptr, &W, restarts, seed, &options, &k);
+    free(low_rank.diagonal_shift);
+    if (symnmf_matrix == NULL && PyErr_Occurred()) {
+        wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+        return NULL;
+    }
+    if (symnmf_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+    }
+    symnmf_matrix_py_ptr = c_result_matrix_to_py(symnmf_matrix, W.n, k, py_is_buffer_matrix(initial_H_py_ptr) || py_is_buffer_matrix(factor_py_ptr));
+    if (symnmf_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+    }
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, factor_wrapper, NULL);
+    return symnmf_matrix_py_ptr;
+}
 
+
+static PyObject* mapped_symnmf_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for calculating SymNMF matrix in C from the datapoints, with the norm matrix calculated into a memory mapped
+       file instead of memory and streamed from it by row blocks every iteration, and returning it to Python program. The norm matrix never
+       goes through Python. Fully handles errors by deallocating memory and exiting program.
+    Input: 
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function, initial H (or the number of columns k), the datapoints and the scratch directory
+          the norm matrix's file is created (and deleted) in.
+        - PyObject *kwargs: restarts (number of C initialized restarts when k is given, defaults to 1), seed (seed of the first one, defaults
+          to 1234), exact (True to evaluate the exponentials with libm, bit exact, instead of the vectorized kernel, defaults to False) and the solver options (see py_solver_options).
+    Returns:
+        Python symnmf matrix, a Matrix if H or the datapoints were given as a buffer.
+    */
+    static char *keywords[] = {"H", "points", "scratch", "restarts", "seed", "solver", "beta", "epsilon", "max_iter", "callback", "exact", NULL};
+    double **symnmf_matrix;
+    norm_operator W;
+    c_matrix_wrapper *datapoints_wrapper;
+    int k, restarts = 1, exact = 0;
+    int max_iter = 300;
+    double beta = 0.5, epsilon = 1e-4;
+    const char *solver = "mu", *scratch;
+    unsigned long seed = 1234;
+    solver_options options;
+    PyObject *initial_H_py_ptr, *datapoints_matrix_py_ptr, *symnmf_matrix_py_ptr, *callback_py_ptr = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOs|iksddiOp", keywords, &initial_H_py_ptr, &datapoints_matrix_py_ptr, &scratch, &restarts, &seed, &solver,
+                                     &beta, &epsilon, &max_iter, &callback_py_ptr, &exact) ||
+        py_solver_options(solver, beta, epsilon, max_iter, callback_py_ptr, &options) != 0) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
     datapoints_wrapper = py_matrix_to_c_matrix(datapoints_matrix_py_ptr);
     if (datapoints_wrapper == NULL) {
         wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
     }
-    sim_matrix = similarity_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols);
-    if (sim_matrix == NULL) {
-        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    Py_BEGIN_ALLOW_THREADS
+    W.mapped = mapped_norm_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, scratch, exact);
+    Py_END_ALLOW_THREADS
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    if (W.mapped == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
     }
-    diag_matrix = diagonal_matrix(sim_matrix, datapoints_wrapper->rows);
-    if (diag_matrix == NULL) {
-        wrapper_function_error_handler(sim_matrix, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    W.representation = mapped_norm;
+    W.n = W.mapped->n;
+    W.dense = W.mapped->rows;
+    W.single_dense = NULL;
+    W.sparse = NULL;
+    W.low_rank = NULL;
+    symnmf_matrix = py_symnmf_solve(initial_H_py_ptr, &W, restarts, seed, &options, &k);
+    free_mapped_matrix(W.mapped);
+    if (symnmf_matrix == NULL && PyErr_Occurred()) {
+        return NULL;
     }
-    diag_matrix_py_ptr = c_matrix_to_py_matrix(diag_matrix, datapoints_wrapper->rows, datapoints_wrapper->rows);
-    wrapper_function_memory_deallocator(sim_matrix, diag_matrix, NULL, NULL, datapoints_wrapper, NULL);
-    return diag_matrix_py_ptr;;
+    if (symnmf_matrix == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    symnmf_matrix_py_ptr = c_result_matrix_to_py(symnmf_matrix, W.n, k, py_is_buffer_matrix(initial_H_py_ptr) || py_is_buffer_matrix(datapoints_matrix_py_ptr));
+    if (symnmf_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    return symnmf_matrix_py_ptr;
 }
 
 
-static PyObject* norm_c_wrapper(PyObject *self, PyObject *args) {
-    /* Python-C Extension wrapper for calculating norm matrix in C and returning it to Python program. Fully handles errors by deallocating memory and exiting program.
+PyObject *c_labels_to_py_list(double **H, Py_ssize_t n, Py_ssize_t k) {
+    /* Converts H to the cluster of every datapoint, the column of its row's largest entry (the first one on ties, like np.argmax).
+    Input: 
+        - double **H: C nxk matrix.
+        - Py_ssize_t n: Number of rows in H.
+        - Py_ssize_t k: Number of columns in H.
+    Returns:
+        Created python list of n ints, NULL on error.
+    */
+    PyObject *labels_py, *label_py;
+    Py_ssize_t i, j, best;
+    labels_py = PyList_New(n);
+    for (i = 0; labels_py != NULL && i < n; i++) {
+        best = 0;
+        for (j = 1; j < k; j++) {
+            if (H[i][j] > H[i][best]) {
+                best = j;
+            }
+        }
+        label_py = PyLong_FromSsize_t(best);
+        if (label_py == NULL) {
+            Py_DECREF(labels_py);
+            return NULL;
+        }
+        PyList_SET_ITEM(labels_py, i, label_py);
+    }
+    return labels_py;
+}
+
+
+static PyObject* fit_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for running SymNMF end to end in C: the norm matrix is built from the datapoints, H is initialized from it
+       (uniformly in [0, 2 * sqrt(mean(W) / k)], see initial_H_creation) and converged, all without the GIL and without W ever reaching
+       Python. Fully handles errors by deallocating memory and exiting program.
     Input: 
         - PyObject *self: reference to wrapper.
-        - PyObject *args: Python arguments calling c function. 
+        - PyObject *args: Python arguments calling c function, the datapoints, the number of clusters k and the seed of the initial H
+          (defaults to 1234, restart r uses seed + r).
+        - PyObject *kwargs: restarts (number of restarts, the lowest objective one is kept, defaults to 1), precision ("double", the default,
+          "single" only with one restart and the "mu" solver, or "mixed"), labels (True to return each datapoint's cluster instead of H),
+          exact (True to evaluate the exponentials with libm, bit exact, instead of the vectorized kernel, defaults to False) and the solver options (see py_solver_options).
     Returns:
-        Python norm matrix
+        Python symnmf matrix (a Matrix if the datapoints were given as a buffer), or list of cluster labels.
     */
-    PyObject *datapoints_matrix_py_ptr, *norm_matrix_py_ptr;
+    static char *keywords[] = {"points", "k", "seed", "restarts", "solver", "beta", "epsilon", "max_iter", "callback", "precision", "labels", "exact", NULL};
+    double **symnmf_matrix;
     c_matrix_wrapper *datapoints_wrapper;
-    double **sim_matrix, **diag_matrix, **nm_matrix;
-    if (!PyArg_ParseTuple(args, "O", &datapoints_matrix_py_ptr)) {
-        printf("An Error Has Occurred\n");
-        exit(EXIT_FAILURE);
-    }
-    if (!PyList_Check(datapoints_matrix_py_ptr)) {
+    int k, restarts = 1, precision_mode, labels = 0, exact = 0;
+    int max_iter = 300;
+    double beta = 0.5, epsilon = 1e-4;
+    const char *solver = "mu", *precision = "double";
+    unsigned long seed = 1234;
+    solver_options options;
+    PyObject *datapoints_matrix_py_ptr, *symnmf_matrix_py_ptr, *callback_py_ptr = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|kisddiOspp", keywords, &datapoints_matrix_py_ptr, &k, &seed, &restarts, &solver,
+                                     &beta, &epsilon, &max_iter, &callback_py_ptr, &precision, &labels, &exact) ||
+        py_solver_options(solver, beta, epsilon, max_iter, callback_py_ptr, &options) != 0 || (precision_mode = py_precision(precision)) < 0 ||
+        restarts < 1 || (precision_mode == 1 && (restarts != 1 || options.method != multiplicative_solver))) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
     datapoints_wrapper = py_matrix_to_c_matrix(datapoints_matrix_py_ptr);
-    if (datapoints_wrapper == NULL) {
-        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    if (datapoints_wrapper == NULL || k <= 0 || k >= datapoints_wrapper->rows) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
     }
-    sim_matrix = similarity_matrix(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols);
-    if (sim_matrix == NULL) {
+    Py_BEGIN_ALLOW_THREADS
+    symnmf_matrix = fit_H(datapoints_wrapper->matrix, datapoints_wrapper->rows, datapoints_wrapper->cols, k, precision_mode, exact, restarts, seed, &options);
+    Py_END_ALLOW_THREADS
+    if (PyErr_Occurred()) {
+        wrapper_function_memory_deallocator(NULL, NULL, NULL, symnmf_matrix, datapoints_wrapper, NULL);
+        return NULL;
+    }
+    if (symnmf_matrix == NULL) {
         wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
     }
-    diag_matrix = diagonal_matrix(sim_matrix, datapoints_wrapper->rows);
-    if (diag_matrix == NULL) {
-        wrapper_function_error_handler(sim_matrix, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    if (labels) {
+        symnmf_matrix_py_ptr = c_labels_to_py_list(symnmf_matrix, datapoints_wrapper->rows, k);
+        free_continuous_matrix(symnmf_matrix);
     }
-    nm_matrix = norm_matrix(sim_matrix, diag_matrix, datapoints_wrapper->rows);
-    if (nm_matrix == NULL) {
-        wrapper_function_error_handler(sim_matrix, diag_matrix, NULL, NULL, datapoints_wrapper, NULL);
+    else {
+        symnmf_matrix_py_ptr = c_result_matrix_to_py(symnmf_matrix, datapoints_wrapper->rows, k, py_is_buffer_matrix(datapoints_matrix_py_ptr));
     }
-    norm_matrix_py_ptr = c_matrix_to_py_matrix(nm_matrix, datapoints_wrapper->rows, datapoints_wrapper->rows);
-    wrapper_function_memory_deallocator(sim_matrix, diag_matrix, nm_matrix, NULL, datapoints_wrapper, NULL);
-    return norm_matrix_py_ptr;;
+    if (symnmf_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    }
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, datapoints_wrapper, NULL);
+    return symnmf_matrix_py_ptr;
 }
 
 
-static PyObject* symnmf_c_wrapper(PyObject *self, PyObject *args) {
-    /* Python-C Extension wrapper for calculating SymNMF matrix in C and returning it to Python program. Fully handles errors by deallocating memory and exiting program.
+static PyObject* read_file_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for reading datapoints in C and returning them to Python program, from either a comma separated text file
+       (parsed in a single pass, see read_datapoints) or a binary dataset (memory mapped, see dataset_open). Fully handles errors by
+       deallocating memory and exiting program.
     Input: 
         - PyObject *self: reference to wrapper.
-        - PyObject *args: Python arguments calling c function. 
+        - PyObject *args: Python arguments calling c function, the file's path.
+        - PyObject *kwargs: buffer (False, the default, for a list of lists, True for a Matrix, the parsed text is handed over without a copy).
     Returns:
-        Python symnmf matrix
+        Python datapoints matrix
     */
-    double **symnmf_matrix;
-    c_matrix_wrapper *initial_H_wrapper, *norm_wrapper;
-    PyObject *initial_H_py_ptr, *norm_matrix_py_ptr, *symnmf_matrix_py_ptr;
-    if (!PyArg_ParseTuple(args, "OO", &initial_H_py_ptr, &norm_matrix_py_ptr)) {
+    static char *keywords[] = {"path", "buffer", NULL};
+    const char *filename;
+    double **datapoints;
+    int num_points, dimension, as_buffer = 0;
+    dataset *data;
+    PyObject *datapoints_matrix_py_ptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|p", keywords, &filename, &as_buffer)) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
+    }
+    if (dataset_is_binary(filename)) {
+        data = dataset_open(filename);
+        if (data == NULL) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+        }
+        datapoints_matrix_py_ptr = as_buffer ? c_matrix_to_py_buffer(copy_c_matrix(data->rows, data->n, data->d), data->n, data->d) :
+                                               c_matrix_to_py_matrix(data->rows, data->n, data->d);
+        free_dataset(data);
+    }
+    else {
+        Py_BEGIN_ALLOW_THREADS
+        datapoints = read_datapoints(filename, &num_points, &dimension);
+        Py_END_ALLOW_THREADS
+        if (datapoints == NULL) {
+            wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+        }
+        datapoints_matrix_py_ptr = c_result_matrix_to_py(datapoints, num_points, dimension, as_buffer);
+    }
+    if (datapoints_matrix_py_ptr == NULL) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
+    }
+    return datapoints_matrix_py_ptr;
+}
+
+
+static PyObject* write_c_wrapper(PyObject *self, PyObject *args, PyObject *kwargs) {
+    /* Python-C Extension wrapper for writing a matrix from Python with the C writer: printed to stdout as per project specifications
+       through one large buffer, or written to a file as a binary dataset (readable by read_file). Fully handles errors by deallocating
+       memory and exiting program.
+    Input: 
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function, the matrix (list of lists or float64 buffer).
+        - PyObject *kwargs: path (None, the default, to print the matrix, or the file the binary dataset is written to).
+    Returns:
+        None
+    */
+    static char *keywords[] = {"matrix", "path", NULL};
+    PyObject *matrix_py_ptr;
+    c_matrix_wrapper *matrix_wrapper;
+    const char *path = NULL;
+    int failed;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|z", keywords, &matrix_py_ptr, &path)) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
-    if (!PyList_Check(initial_H_py_ptr) || !PyList_Check(norm_matrix_py_ptr)) {
+    if (PyObject_Length(matrix_py_ptr) <= 0) {
         printf("An Error Has Occurred\n");
         exit(EXIT_FAILURE);
     }
-    norm_wrapper = py_matrix_to_c_matrix(norm_matrix_py_ptr);
-    if (norm_wrapper == NULL) {
+    matrix_wrapper = py_matrix_to_c_matrix(matrix_py_ptr);
+    if (matrix_wrapper == NULL) {
         wrapper_function_error_handler(NULL, NULL, NULL, NULL, NULL, NULL);
     }
-    initial_H_wrapper = py_matrix_to_c_matrix(initial_H_py_ptr);
-    if (norm_wrapper == NULL) {
-        wrapper_function_error_handler(NULL, NULL, NULL, NULL, norm_wrapper, NULL);
+    set_binary_output(path);
+    failed = print_matrix(matrix_wrapper->matrix, matrix_wrapper->rows, matrix_wrapper->cols);
+    set_binary_output(NULL);
+    if (failed) {
+        wrapper_function_error_handler(NULL, NULL, NULL, NULL, matrix_wrapper, NULL);
     }
-    symnmf_matrix = converge_H(initial_H_wrapper->matrix, norm_wrapper->matrix, initial_H_wrapper->rows, initial_H_wrapper->cols);
-    if (symnmf_matrix == NULL) {
-        wrapper_function_error_handler(NULL, NULL, NULL, NULL, norm_wrapper, initial_H_wrapper);
+    wrapper_function_memory_deallocator(NULL, NULL, NULL, NULL, matrix_wrapper, NULL);
+    Py_RETURN_NONE;
+}
+
+
+static PyObject* set_num_threads_c_wrapper(PyObject *self, PyObject *args) {
+    /* Python-C Extension wrapper for setting the number of threads the parallel kernels use.
+    Input: 
+        - PyObject *self: reference to wrapper.
+        - PyObject *args: Python arguments calling c function, a single positive integer.
+    Returns:
+        None
+    */
+    int threads;
+    if (!PyArg_ParseTuple(args, "i", &threads) || threads <= 0) {
+        printf("An Error Has Occurred\n");
+        exit(EXIT_FAILURE);
     }
-    symnmf_matrix_py_ptr = c_matrix_to_py_matrix(symnmf_matrix, initial_H_wrapper->rows, initial_H_wrapper->cols);
-    wrapper_function_memory_deallocator(NULL, NULL, NULL, symnmf_matrix, norm_wrapper, initial_H_wrapper);
-    return symnmf_matrix_py_ptr;
+    set_num_threads(threads);
+    Py_RETURN_NONE;
 }
 
 
 static PyMethodDef SymNMFMethods[] = {
     {
         "sym", 
-        (PyCFunction) sym_c_wrapper,
-        METH_VARARGS,
+        (PyCFunction)(void (*)(void)) sym_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
         "sym C Wrapper"
     },
     {
         "diag", 
-        (PyCFunction) diag_c_wrapper,
-        METH_VARARGS,
+        (PyCFunction)(void (*)(void)) diag_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
         "diag C Wrapper"
     },
     {
         "norm", 
-        (PyCFunction) norm_c_wrapper,
-        METH_VARARGS,
+        (PyCFunction)(void (*)(void)) norm_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
         "norm C Wrapper"
     },
     {
         "symnmf", 
-        (PyCFunction) symnmf_c_wrapper,
-        METH_VARARGS,
+        (PyCFunction)(void (*)(void)) symnmf_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
         "SymNMF C Wrapper"
     },
+    {
+        "sparse_norm", 
+        (PyCFunction)(void (*)(void)) sparse_norm_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "sparse norm C Wrapper"
+    },
+    {
+        "sparse_symnmf", 
+        (PyCFunction)(void (*)(void)) sparse_symnmf_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "sparse SymNMF C Wrapper"
+    },
+    {
+        "nystrom_norm", 
+        (PyCFunction)(void (*)(void)) nystrom_norm_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "Nystrom low rank norm C Wrapper"
+    },
+    {
+        "low_rank_symnmf", 
+        (PyCFunction)(void (*)(void)) low_rank_symnmf_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "low rank SymNMF C Wrapper"
+    },
+    {
+        "mapped_symnmf", 
+        (PyCFunction)(void (*)(void)) mapped_symnmf_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "memory mapped SymNMF C Wrapper"
+    },
+    {
+        "fit", 
+        (PyCFunction)(void (*)(void)) fit_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "end to end SymNMF C Wrapper"
+    },
+    {
+        "read_file", 
+        (PyCFunction)(void (*)(void)) read_file_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "read datapoints C Wrapper"
+    },
+    {
+        "write", 
+        (PyCFunction)(void (*)(void)) write_c_wrapper,
+        METH_VARARGS | METH_KEYWORDS,
+        "write matrix C Wrapper"
+    },
+    {
+        "set_num_threads", 
+        (PyCFunction) set_num_threads_c_wrapper,
+        METH_VARARGS,
+        "Set the number of threads used by the C kernels"
+    },
     {NULL, NULL, 0, NULL}
   };
 
@@ -331,5 +1719,13 @@ PyMODINIT_FUNC PyInit_symnmf_c(void) {
       if (!module) {
           return NULL;
       }
+      py_matrix_type = PyType_FromSpec(&py_matrix_spec);
+      if (py_matrix_type == NULL || PyModule_AddObject(module, "Matrix", py_matrix_type) != 0) {
+          Py_XDECREF(py_matrix_type);
+          Py_DECREF(module);
+          return NULL;
+      }
+      Py_INCREF(py_matrix_type); /* The module's reference went to the attribute, py_matrix_type keeps its own */
+      num_threads_from_environment();
       return module;
 }
\ No newline at end of file
@@ -1,32 +1,26 @@
+#include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
-
-double **continuous_matrix_creation(int m, int n) {
-    /* Creates a continuous matrix via method shown in class . Returns NULL on error.
-    Input:
-        - int m: Number of rows in matrix
-        - int n: Number of columns in matrix
-    Returns:
-        - Continuous mxn matrix, all elements are zero instantiated by default due to use of calloc
-    */
-    int i;
-    double *flattened_matrix;
-    double **matrix;
-
-    flattened_matrix = calloc(m * n, sizeof(double));
-    matrix = calloc(m, sizeof(double *));
-    if (flattened_matrix == NULL || matrix == NULL){
-        free(flattened_matrix);
-        free(matrix);
-        return NULL;
-    }
-
-    for (i = 0; i < m; i++) {
-        matrix[i] = flattened_matrix + i * n;
-    }
-
-    return matrix;
-}
+#include "gemm.h"
+#include "writer.h"
+#include "parallel.h"
+#define symmetric_block_size 64
+
+/* Matrix storage and the symmetric products in double precision, in single precision with an _f32 suffix, and the product of a single
+   precision symmetric matrix with a double precision one with a _mixed suffix */
+#define real double
+#define real_a double
+#define precision_function(name) name
+#include "utils_template.c"
+#define real float
+#define real_a float
+#define precision_function(name) name ## _f32
+#include "utils_template.c"
+#define real double
+#define real_a float
+#define precision_function(name) name ## _mixed
+#define mixed_precision
+#include "utils_template.c"
 
 
 double **matrix_deep_copy(double **matrix_to_copy, int m, int n) {
@@ -83,7 +77,7 @@ double **matrix_subtraction(double **matrix, double **other_matrix, int m, int n
 
 
 double **matrix_multiplication(double **matrix, double **other_matrix, int m, int s, int n) {
-    /* Multiplies two matrices together. Returns NULL on error.
+    /* Multiplies two matrices together through the cache blocked, vectorized gemm, blocks of rows are split between threads. Returns NULL on error.
     Input:
         - double matrix[][]: Left matrix we are multiplying by.
         - double other_matrix[][]: Right matrix we are multiplying by.
@@ -93,21 +87,23 @@ double **matrix_multiplication(double **matrix, double **other_matrix, int m, in
     Returns:
         mxn result of multiplying the matrices.
     */
-    int i;
-    int j;
-    int k;
-    double **result_matrix;
+    int row_block, threads = num_threads();
+    double **result_matrix, *gemm_scratch;
     result_matrix = continuous_matrix_creation(m, n);
-    if (result_matrix == NULL) {
+    gemm_scratch = malloc((size_t)threads * gemm_scratch_size * sizeof(double));
+    if (result_matrix == NULL || gemm_scratch == NULL) {
+        free_continuous_matrix(result_matrix);
+        free(gemm_scratch);
         return NULL;
     }
-    for (i = 0; i < m; i++) {
-        for (j = 0; j < n; j++) {
-            for (k = 0; k < s; k++) {
-                result_matrix[i][j] += matrix[i][k] * other_matrix[k][j];
-            }
-        }
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+    for (row_block = 0; row_block < m; row_block += symmetric_block_size) {
+        gemm(matrix, row_block, 0, 0, other_matrix, 0, result_matrix, row_block, (row_block + symmetric_block_size < m) ? symmetric_block_size : m - row_block, s, n,
+             gemm_scratch + (size_t)thread_number() * gemm_scratch_size);
     }
+    free(gemm_scratch);
     return result_matrix;
 }
 
@@ -172,35 +168,22 @@ void free_matrix(double **matrix, int num_rows) {
 }
 
 
-void free_continuous_matrix(double **continuous_matrix) {
-    /* Frees up continuous matrix memory by freeing the pointer to the flattened array, at continuous_matrix[0] and 
-       then freeing continuous_matrix: the array(pointer) of "pseudo-row" pointers(which are part of the flattened array allocation and therefore dont need to be freed)
-       which point to the appropriate row positions in the flattened array.
+int print_diagonal_matrix(double *diagonal, int n) {
+    /* Prints full diagonal matrix given by its diagonal alone as per project specifications, or writes it as a binary dataset (see
+       set_binary_output). Returns -1 on error, 0 otherwise.
     Input:
-        - double matrix[][]: Matrix whose memory we are freeing
-        - int num_rows: Number of rows in the matrix
-    */
-    if (continuous_matrix == NULL) return;
-    free(continuous_matrix[0]);  /* Free the flattened array */
-    free(continuous_matrix);     /* Free the array of row pointers */
-}
-
-
-void print_matrix(double **matrix, int m, int n) {
-    /* Prints matrix as per project specifications.
-    Input:
-        - double **matrix: The matrix to be printed
-        - int m: Number of rows
-        - int n: Number of columns
+        - double *diagonal: Diagonal of the matrix to be printed
+        - int n: Number of rows and columns
     */
     int i, j;
-    for (i = 0; i < m; i++) {
+    matrix_writer writer;
+    if (matrix_writer_open(&writer, n, n) != 0) {
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
         for (j = 0; j < n; j++) {
-            printf("%.4f", matrix[i][j]);  /* Print each element as an integer (no decimal) */
-            if (j < n-1) {
-                putchar(',');
-            }
+            matrix_writer_value(&writer, (i == j) ? diagonal[i] : 0.0);
         }
-        printf("\n");
     }
-}
\ No newline at end of file
+    return matrix_writer_close(&writer);
+}
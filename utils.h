@@ -1,18 +1,63 @@
-
 double **continuous_matrix_creation(int m, int n);
 
+double **triangular_matrix_creation(int n);
+
+double symmetric_entry(double **symmetric_matrix, int i, int j);
+
 double **matrix_deep_copy(double **matrix_to_copy, int m, int n);
 
 double **matrix_subtraction(double **matrix, double **other_matrix, int m, int n);
 
 double **matrix_multiplication(double **matrix, double **other_matrix, int m, int s, int n);
 
+void symmetric_matrix_multiplication(double **symmetric_matrix, double **matrix, double **result_matrix, double *gemm_scratch, int threads, int n, int k);
+
+void gram_matrix(double **matrix, double **result_matrix, int m, int n);
+
+void matrix_symmetric_multiplication(double **matrix, double **symmetric_matrix, double **result_matrix, int m, int k);
+
 double **matrix_transpose(double **matrix, int m, int n);
 
 double matrix_trace(double **matrix, int n);
 
+double symmetric_frobenius_squared(double **symmetric_matrix, int n);
+
+double symmetric_sum(double **symmetric_matrix, int n);
+
+double symmetric_max_row_sum(double **symmetric_matrix, int n);
+
 void free_matrix(double **matrix, int num_rows);
 
 void free_continuous_matrix(double **continuous_matrix);
 
-void print_matrix(double **matrix, int m, int n);
\ No newline at end of file
+int print_matrix(double **matrix, int m, int n);
+
+int print_symmetric_matrix(double **symmetric_matrix, int n);
+
+int print_diagonal_matrix(double *diagonal, int n);
+
+float **continuous_matrix_creation_f32(int m, int n);
+
+float **triangular_matrix_creation_f32(int n);
+
+float symmetric_entry_f32(float **symmetric_matrix, int i, int j);
+
+void symmetric_matrix_multiplication_f32(float **symmetric_matrix, float **matrix, float **result_matrix, float *gemm_scratch, int threads, int n, int k);
+
+void gram_matrix_f32(float **matrix, float **result_matrix, int m, int n);
+
+void matrix_symmetric_multiplication_f32(float **matrix, float **symmetric_matrix, float **result_matrix, int m, int k);
+
+double symmetric_frobenius_squared_f32(float **symmetric_matrix, int n);
+
+double symmetric_sum_f32(float **symmetric_matrix, int n);
+
+double symmetric_max_row_sum_f32(float **symmetric_matrix, int n);
+
+void free_continuous_matrix_f32(float **continuous_matrix);
+
+int print_matrix_f32(float **matrix, int m, int n);
+
+int print_symmetric_matrix_f32(float **symmetric_matrix, int n);
+
+void symmetric_matrix_multiplication_mixed(float **symmetric_matrix, double **matrix, double **result_matrix, double *gemm_scratch, int threads, int n, int k);
@@ -0,0 +1,318 @@
+/* Type generic source of utils.c's matrix storage and symmetric products, included once per precision. The includer defines real
+   (the element type), real_a (the element type of symmetric_matrix_multiplication's symmetric matrix, read as real) and
+   precision_function(name) (the name of a function's instantiation). If mixed_precision is defined, real_a differs from real and
+   only symmetric_matrix_multiplication is emitted. All of them are undefined again at the end. */
+
+
+#ifndef mixed_precision
+real **precision_function(continuous_matrix_creation)(int m, int n) {
+    /* Creates a continuous matrix via method shown in class . Returns NULL on error.
+    Input:
+        - int m: Number of rows in matrix
+        - int n: Number of columns in matrix
+    Returns:
+        - Continuous mxn matrix, all elements are zero instantiated by default due to use of calloc
+    */
+    int i;
+    real *flattened_matrix;
+    real **matrix;
+
+    flattened_matrix = calloc((size_t)m * n, sizeof(real));
+    matrix = calloc(m, sizeof(real *));
+    if (flattened_matrix == NULL || matrix == NULL){
+        free(flattened_matrix);
+        free(matrix);
+        return NULL;
+    }
+
+    for (i = 0; i < m; i++) {
+        matrix[i] = flattened_matrix + i * n;
+    }
+
+    return matrix;
+}
+
+
+real **precision_function(triangular_matrix_creation)(int n) {
+    /* Creates a packed upper triangular nxn matrix for symmetric matrices, only the n(n+1)/2 entries on or above the diagonal are stored. Returns NULL on error.
+       Row i points i entries before its first stored entry, so matrix[i][j] is valid for every j >= i exactly like a continuous matrix,
+       this also means any full continuous matrix can be passed wherever a triangular one is expected. Freed with free_continuous_matrix.
+    Input:
+        - int n: Number of rows and columns in the symmetric matrix
+    Returns:
+        - Triangular nxn matrix, all stored elements are zero instantiated by default due to use of calloc
+    */
+    int i;
+    real *flattened_matrix;
+    real **matrix;
+
+    flattened_matrix = calloc((size_t)n * (n + 1) / 2, sizeof(real));
+    matrix = calloc(n, sizeof(real *));
+    if (flattened_matrix == NULL || matrix == NULL){
+        free(flattened_matrix);
+        free(matrix);
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        matrix[i] = flattened_matrix + (size_t)i * n - (size_t)i * (i + 1) / 2;
+    }
+
+    return matrix;
+}
+
+
+real precision_function(symmetric_entry)(real **symmetric_matrix, int i, int j) {
+    /* Reads entry (i, j) of a symmetric matrix of which only the upper triangle is stored.
+    Input:
+        - real symmetric_matrix[][]: Triangular matrix.
+        - int i: Row of the entry.
+        - int j: Column of the entry.
+    Returns:
+        - Entry (i, j) of the full symmetric matrix.
+    */
+    return (i <= j) ? symmetric_matrix[i][j] : symmetric_matrix[j][i];
+}
+
+
+void precision_function(gram_matrix)(real **matrix, real **result_matrix, int m, int n) {
+    /* Calculates M^T * M, which is symmetric, straight into a triangular matrix (symmetric rank-n update), without forming the transpose.
+       Rows of M are streamed once, each adding its outer product to the upper triangle.
+    Input:
+        - real matrix[][]: mxn matrix M.
+        - real result_matrix[][]: nxn triangular matrix M^T * M is written to, its previous contents are overwritten.
+        - int m: Number of rows in the matrix.
+        - int n: Number of columns in the matrix.
+    */
+    int i, a, b;
+    real entry;
+    for (a = 0; a < n; a++) {
+        for (b = a; b < n; b++) {
+            result_matrix[a][b] = 0.0;
+        }
+    }
+    for (i = 0; i < m; i++) {
+        for (a = 0; a < n; a++) {
+            entry = matrix[i][a];
+            for (b = a; b < n; b++) {
+                result_matrix[a][b] += entry * matrix[i][b];
+            }
+        }
+    }
+}
+
+
+void precision_function(matrix_symmetric_multiplication)(real **matrix, real **symmetric_matrix, real **result_matrix, int m, int k) {
+    /* Multiplies a regular matrix by a symmetric matrix stored as a triangular matrix (from the right).
+    Input:
+        - real matrix[][]: Left mxk matrix.
+        - real symmetric_matrix[][]: Right kxk symmetric matrix, only entries on or above the diagonal are read.
+        - real result_matrix[][]: mxk matrix the result of multiplying the matrices is written to, its previous contents are overwritten.
+        - int m: Number of rows in left matrix.
+        - int k: Number of columns in left matrix / Size of the symmetric matrix.
+    */
+    int i, a, b;
+#ifdef _OPENMP
+    #pragma omp parallel for private(a, b) schedule(static) num_threads(num_threads())
+#endif
+    for (i = 0; i < m; i++) {
+        for (a = 0; a < k; a++) {
+            result_matrix[i][a] = 0.0;
+        }
+        for (a = 0; a < k; a++) {
+            result_matrix[i][a] += matrix[i][a] * symmetric_matrix[a][a];
+            for (b = a + 1; b < k; b++) {
+                result_matrix[i][b] += matrix[i][a] * symmetric_matrix[a][b];
+                result_matrix[i][a] += matrix[i][b] * symmetric_matrix[a][b];
+            }
+        }
+    }
+}
+
+
+double precision_function(symmetric_frobenius_squared)(real **symmetric_matrix, int n) {
+    /* Calculates the sum of the squares of a symmetric matrix's entries from its upper triangle, in double precision.
+    Input:
+        - real symmetric_matrix[][]: nxn triangular matrix.
+        - int n: Number of rows and columns in the matrix.
+    Returns:
+        ||symmetric_matrix||_F^2
+    */
+    int i, j;
+    double sum = 0.0;
+    for (i = 0; i < n; i++) {
+        sum += (double)symmetric_matrix[i][i] * symmetric_matrix[i][i];
+        for (j = i + 1; j < n; j++) {
+            sum += 2.0 * symmetric_matrix[i][j] * symmetric_matrix[i][j]; /* Entry (i, j) also stands in for entry (j, i) */
+        }
+    }
+    return sum;
+}
+
+
+double precision_function(symmetric_sum)(real **symmetric_matrix, int n) {
+    /* Calculates the sum of all of a symmetric matrix's entries from its upper triangle, in double precision.
+    Input:
+        - real symmetric_matrix[][]: nxn triangular matrix.
+        - int n: Number of rows and columns in the matrix.
+    Returns:
+        Sum of the entries.
+    */
+    int i, j;
+    double sum = 0.0;
+    for (i = 0; i < n; i++) {
+        sum += symmetric_matrix[i][i];
+        for (j = i + 1; j < n; j++) {
+            sum += 2.0 * symmetric_matrix[i][j]; /* Entry (i, j) also stands in for entry (j, i) */
+        }
+    }
+    return sum;
+}
+
+
+double precision_function(symmetric_max_row_sum)(real **symmetric_matrix, int n) {
+    /* Calculates max_i sum_j |A_ij| of a symmetric matrix from its upper triangle, in double precision. Returns -1.0 on error.
+    Input:
+        - real symmetric_matrix[][]: nxn triangular matrix.
+        - int n: Number of rows and columns in the matrix.
+    Returns:
+        The largest absolute row sum.
+    */
+    int i, j;
+    double largest = 0.0;
+    double *row_sums = calloc(n, sizeof(double));
+    if (row_sums == NULL) {
+        return -1.0;
+    }
+    for (i = 0; i < n; i++) {
+        row_sums[i] += fabs(symmetric_matrix[i][i]);
+        for (j = i + 1; j < n; j++) {
+            row_sums[i] += fabs(symmetric_matrix[i][j]); /* Entry (i, j) also stands in for entry (j, i) */
+            row_sums[j] += fabs(symmetric_matrix[i][j]);
+        }
+        if (row_sums[i] > largest) largest = row_sums[i];
+    }
+    free(row_sums);
+    return largest;
+}
+
+
+void precision_function(free_continuous_matrix)(real **continuous_matrix) {
+    /* Frees up continuous matrix memory by freeing the pointer to the flattened array, at continuous_matrix[0] and 
+       then freeing continuous_matrix: the array(pointer) of "pseudo-row" pointers(which are part of the flattened array allocation and therefore dont need to be freed)
+       which point to the appropriate row positions in the flattened array.
+    Input:
+        - real matrix[][]: Matrix whose memory we are freeing
+        - int num_rows: Number of rows in the matrix
+    */
+    if (continuous_matrix == NULL) return;
+    free(continuous_matrix[0]);  /* Free the flattened array */
+    free(continuous_matrix);     /* Free the array of row pointers */
+}
+
+
+int precision_function(print_matrix)(real **matrix, int m, int n) {
+    /* Prints matrix as per project specifications, or writes it as a binary dataset (see set_binary_output). Returns -1 on error, 0 otherwise.
+    Input:
+        - real **matrix: The matrix to be printed
+        - int m: Number of rows
+        - int n: Number of columns
+    */
+    int i, j;
+    matrix_writer writer;
+    if (matrix_writer_open(&writer, m, n) != 0) {
+        return -1;
+    }
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < n; j++) {
+            matrix_writer_value(&writer, matrix[i][j]);
+        }
+    }
+    return matrix_writer_close(&writer);
+}
+
+
+int precision_function(print_symmetric_matrix)(real **symmetric_matrix, int n) {
+    /* Prints full symmetric matrix stored as a triangular matrix as per project specifications, or writes it as a binary dataset (see
+       set_binary_output). Returns -1 on error, 0 otherwise.
+    Input:
+        - real **symmetric_matrix: Triangular matrix to be printed
+        - int n: Number of rows and columns
+    */
+    int i, j;
+    matrix_writer writer;
+    if (matrix_writer_open(&writer, n, n) != 0) {
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            matrix_writer_value(&writer, precision_function(symmetric_entry)(symmetric_matrix, i, j));
+        }
+    }
+    return matrix_writer_close(&writer);
+}
+#endif
+
+
+void precision_function(symmetric_matrix_multiplication)(real_a **symmetric_matrix, real **matrix, real **result_matrix, real *gemm_scratch, int threads, int n, int k) {
+    /* Multiplies a symmetric matrix stored as a triangular matrix by a regular matrix. The triangle is split into square blocks, every block
+       (I, J) strictly above the diagonal is a regular matrix that contributes A_IJ * H_J to rows I and A_IJ^T * H_I to rows J, both through
+       gemm. Blocks on the diagonal only hold their own upper triangle and are done directly. So that threads never write the same rows,
+       the first phase gives each thread whole block rows (diagonal block and A_IJ * H_J for every J after it) and the second phase whole
+       block columns (A_IJ^T * H_I for every I before it).
+    Input:
+        - real_a symmetric_matrix[][]: Left nxn symmetric matrix, only entries on or above the diagonal are read.
+        - real matrix[][]: Right nxk matrix.
+        - real result_matrix[][]: nxk matrix the result of multiplying the matrices is written to, its previous contents are overwritten.
+        - real gemm_scratch[]: threads * gemm_scratch_size values of scratch, one gemm_scratch_size slice per thread.
+        - int threads: Number of threads to split the blocks between.
+        - int n: Size of the symmetric matrix / Number of rows in right matrix.
+        - int k: Number of columns in right matrix.
+    */
+    int i, j, c, row_block, col_block, row_end, col_end;
+    real entry, *scratch;
+#ifdef _OPENMP
+    #pragma omp parallel private(i, j, c, col_block, row_end, col_end, entry, scratch) num_threads(threads)
+#endif
+    {
+        scratch = gemm_scratch + (size_t)thread_number() * gemm_scratch_size;
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (row_block = 0; row_block < n; row_block += symmetric_block_size) {
+            row_end = (row_block + symmetric_block_size < n) ? row_block + symmetric_block_size : n;
+            for (i = row_block; i < row_end; i++) {
+                for (c = 0; c < k; c++) {
+                    result_matrix[i][c] = symmetric_matrix[i][i] * matrix[i][c];
+                }
+            }
+            for (i = row_block; i < row_end; i++) {
+                for (j = i + 1; j < row_end; j++) {
+                    entry = symmetric_matrix[i][j];
+                    for (c = 0; c < k; c++) {
+                        result_matrix[i][c] += entry * matrix[j][c];
+                        result_matrix[j][c] += entry * matrix[i][c];
+                    }
+                }
+            }
+            for (col_block = row_end; col_block < n; col_block += symmetric_block_size) {
+                col_end = (col_block + symmetric_block_size < n) ? col_block + symmetric_block_size : n;
+                precision_function(gemm)(symmetric_matrix, row_block, col_block, 0, matrix, col_block, result_matrix, row_block, row_end - row_block, col_end - col_block, k, scratch);
+            }
+        }
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (col_block = symmetric_block_size; col_block < n; col_block += symmetric_block_size) {
+            col_end = (col_block + symmetric_block_size < n) ? col_block + symmetric_block_size : n;
+            for (i = 0; i < col_block; i += symmetric_block_size) {
+                precision_function(gemm)(symmetric_matrix, i, col_block, 1, matrix, i, result_matrix, col_block, col_end - col_block, symmetric_block_size, k, scratch);
+            }
+        }
+    }
+}
+
+#undef real
+#undef real_a
+#undef precision_function
+#undef mixed_precision
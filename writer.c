@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "dataset.h"
+#include "writer.h"
+
+static const char *binary_output = NULL;
+
+
+void set_binary_output(const char *filename) {
+    /* Chooses where matrices go, process wide.
+    Input:
+        - const char *filename: If not NULL every matrix written from now on is written to this file as a binary dataset (see dataset.c),
+          overwriting it, instead of being printed to stdout as text (default).
+    */
+    binary_output = filename;
+}
+
+
+int format_fixed4(double value, char *out) {
+    /* Formats a number exactly like printf("%.4f"), without going through printf for the numbers a matrix normally holds. Below
+       writer_fast_limit the number times 10^4 is rounded to an integer directly, its rounding error is far below writer_tie_margin so only
+       numbers whose exact value lies within writer_tie_margin of a tie (where printf's rounding of the exact binary value decides) and
+       larger, infinite or nan numbers go to sprintf.
+    Input:
+        - double value: Number to format.
+        - char out[]: Receives the text, null terminated, room for at least writer_reserve characters.
+    Returns:
+        Number of characters written, without the terminating null.
+    */
+    double magnitude, scaled, rounded, integer_part;
+    int negative = (value < 0.0) || (value == 0.0 && 1.0 / value < 0.0); /* printf keeps the sign of negative zero */
+    int fraction, whole, length = 0, count = 0, i;
+    char digits[8];
+    magnitude = negative ? -value : value;
+    if (!(magnitude < writer_fast_limit)) {
+        return sprintf(out, "%.4f", value);
+    }
+    scaled = magnitude * 10000.0;
+    if (fabs(scaled - floor(scaled) - 0.5) < writer_tie_margin) {
+        return sprintf(out, "%.4f", value);
+    }
+    rounded = floor(scaled + 0.5);
+    integer_part = floor(rounded / 10000.0);
+    fraction = (int)(rounded - integer_part * 10000.0);
+    whole = (int)integer_part;
+    if (negative) {
+        out[length++] = '-';
+    }
+    do {
+        digits[count++] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (count > 0) {
+        out[length++] = digits[--count];
+    }
+    out[length++] = '.';
+    for (i = 3; i >= 0; i--) {
+        out[length + i] = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    length += 4;
+    out[length] = '\0';
+    return length;
+}
+
+
+int matrix_writer_open(matrix_writer *writer, int m, int n) {
+    /* Starts writing an mxn matrix, as text to stdout or as a binary dataset to the file chosen with set_binary_output. Returns -1 if the
+       file can't be opened, 0 otherwise.
+    Input:
+        - matrix_writer *writer: Writer to start.
+        - int m: Number of rows.
+        - int n: Number of columns.
+    */
+    writer->columns = n;
+    writer->column = 0;
+    writer->failed = 0;
+    writer->length = 0;
+    writer->binary = (binary_output != NULL);
+    writer->stream = stdout;
+    if (!writer->binary) {
+        return 0;
+    }
+    writer->stream = fopen(binary_output, "wb");
+    if (writer->stream == NULL) {
+        return -1;
+    }
+    dataset_header((unsigned char *)writer->buffer, m, n, sizeof(double));
+    writer->length = dataset_header_size;
+    return 0;
+}
+
+
+void matrix_writer_flush(matrix_writer *writer) {
+    /* Writes out everything the writer has buffered.
+    Input:
+        - matrix_writer *writer: Writer to flush.
+    */
+    if (writer->length > 0 && fwrite(writer->buffer, 1, writer->length, writer->stream) != writer->length) {
+        writer->failed = 1;
+    }
+    writer->length = 0;
+}
+
+
+void matrix_writer_value(matrix_writer *writer, double value) {
+    /* Appends the next entry of the matrix, in row major order. In text mode entries are formatted with format_fixed4 and separated by
+       commas, with a newline after each row's last entry, exactly as printing them one by one with printf would.
+    Input:
+        - matrix_writer *writer: Writer of the matrix.
+        - double value: Next entry.
+    */
+    if (writer->length + writer_reserve > writer_buffer_size) {
+        matrix_writer_flush(writer);
+    }
+    if (writer->binary) {
+        memcpy(writer->buffer + writer->length, &value, sizeof(double));
+        writer->length += sizeof(double);
+        return;
+    }
+    writer->length += format_fixed4(value, writer->buffer + writer->length);
+    writer->column++;
+    if (writer->column == writer->columns) {
+        writer->buffer[writer->length++] = '\n';
+        writer->column = 0;
+    }
+    else {
+        writer->buffer[writer->length++] = ',';
+    }
+}
+
+
+int matrix_writer_close(matrix_writer *writer) {
+    /* Finishes writing the matrix: flushes the writer and stdout, or closes the binary file. Returns -1 if any write failed, 0 otherwise.
+    Input:
+        - matrix_writer *writer: Writer to finish.
+    */
+    matrix_writer_flush(writer);
+    if (writer->binary) {
+        writer->failed |= (fclose(writer->stream) != 0);
+    }
+    else {
+        writer->failed |= (fflush(writer->stream) != 0);
+    }
+    return writer->failed ? -1 : 0;
+}
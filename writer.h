@@ -0,0 +1,26 @@
+#define writer_buffer_size (1 << 16)
+#define writer_reserve 512
+#define writer_fast_limit 1e6
+#define writer_tie_margin 1e-5
+
+typedef struct matrix_writer {
+    FILE *stream;
+    int binary;
+    int columns;
+    int column;
+    int failed;
+    size_t length;
+    char buffer[writer_buffer_size];
+} matrix_writer;
+
+void set_binary_output(const char *filename);
+
+int format_fixed4(double value, char *out);
+
+int matrix_writer_open(matrix_writer *writer, int m, int n);
+
+void matrix_writer_flush(matrix_writer *writer);
+
+void matrix_writer_value(matrix_writer *writer, double value);
+
+int matrix_writer_close(matrix_writer *writer);